@@ -0,0 +1,94 @@
+#
+# generates one partially evaluated entry point per scoring configuration
+# listed in a specialization table and a matching C++ dispatch table
+#
+# table format (one configuration per line, '#' starts a comment):
+#   <global|semiglobal|local> <match> <mismatch> <gap>
+#
+# generated files:
+#   <outdir>/specializations.impala   (Impala entry points)
+#   <outdir>/specializations.inc      (C declarations + dispatch table)
+#
+
+function(anyseq_generate_specializations table outdir)
+
+    set(impala "//-------------------------------------------------------------------\n")
+    string(APPEND impala "// generated from ${table}; do not edit\n")
+    string(APPEND impala "//-------------------------------------------------------------------\n")
+
+    set(decls "// generated from ${table}; do not edit\n\nextern \"C\" {\n\n")
+    set(entries "")
+
+    if(table AND EXISTS "${table}")
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${table}")
+        file(STRINGS "${table}" lines)
+    else()
+        if(table)
+            message(WARNING "specialization table ${table} not found")
+        endif()
+        set(lines "")
+    endif()
+
+    set(num 0)
+    foreach(line IN LISTS lines)
+        string(REGEX REPLACE "#.*$" "" line "${line}")
+        string(STRIP "${line}" line)
+        if(line STREQUAL "")
+            continue()
+        endif()
+
+        if(NOT line MATCHES "^(global|semiglobal|local)[ \t]+(-?[0-9]+)[ \t]+(-?[0-9]+)[ \t]+(-?[0-9]+)$")
+            message(FATAL_ERROR "malformed specialization: '${line}'")
+        endif()
+        set(scheme   ${CMAKE_MATCH_1})
+        set(match    ${CMAKE_MATCH_2})
+        set(mismatch ${CMAKE_MATCH_3})
+        set(gap      ${CMAKE_MATCH_4})
+
+        set(score_fn     "${scheme}_alignment_score_spec${num}")
+        set(construct_fn "construct_${scheme}_alignment_spec${num}")
+        set(scoring      "${scheme}_scheme( linear_scoring(${match},${mismatch},${gap}))")
+
+        string(APPEND impala "\n\n// ${scheme} ${match} ${mismatch} ${gap}\n")
+        string(APPEND impala "extern \nfn ${score_fn}(\n")
+        string(APPEND impala "    query: &[u8], len_q: Index, \n")
+        string(APPEND impala "    subject: &[u8], len_s: Index) -> Score\n{\n")
+        string(APPEND impala "    let qry_seq = wrap_sequence(query, len_q);\n")
+        string(APPEND impala "    let sub_seq = wrap_sequence(subject, len_s);\n\n")
+        string(APPEND impala "    alignment_score(qry_seq, sub_seq, ${scoring})\n}\n\n")
+
+        string(APPEND impala "extern \nfn ${construct_fn}(\n")
+        string(APPEND impala "    query: &[u8], len_q: Index, \n")
+        string(APPEND impala "    subject: &[u8], len_s: Index, \n")
+        string(APPEND impala "    alQuery: &[u8], alSubject: &[u8], alCapacity: Index, alInfo: &mut[Index]) -> Score\n{\n")
+        string(APPEND impala "    let qry_seq = wrap_sequence(query, len_q);\n")
+        string(APPEND impala "    let sub_seq = wrap_sequence(subject, len_s);\n\n")
+        string(APPEND impala "    let qry_out = wrap_sequence(alQuery, alCapacity);\n")
+        string(APPEND impala "    let sub_out = wrap_sequence(alSubject, alCapacity);\n\n")
+        string(APPEND impala "    alignment_tb(qry_seq, sub_seq, qry_out, sub_out, \n")
+        string(APPEND impala "                 alignment_info(alInfo, 0), ${scoring})\n}\n")
+
+        string(APPEND decls "score_t ${score_fn}(const char*, int, const char*, int);\n")
+        string(APPEND decls "score_t ${construct_fn}(const char*, int, const char*, int, char*, char*, int, int*);\n")
+
+        string(APPEND entries "    { alignment_type::${scheme}, {${match}, ${mismatch}, ${gap}}, ${score_fn}, ${construct_fn} },\n")
+
+        math(EXPR num "${num} + 1")
+    endforeach()
+
+    string(APPEND decls "\n} // extern \"C\"\n\n\n")
+    string(APPEND decls "static const specialization specializations[] = {\n")
+    string(APPEND decls "${entries}")
+    string(APPEND decls "    // sentinel; keeps the array non-empty\n")
+    string(APPEND decls "    { alignment_type::global, {0, 0, 0}, nullptr, nullptr }\n")
+    string(APPEND decls "};\n")
+
+    # only touch the outputs if their content changed
+    file(WRITE "${outdir}/specializations.impala.tmp" "${impala}")
+    file(WRITE "${outdir}/specializations.inc.tmp" "${decls}")
+    configure_file("${outdir}/specializations.impala.tmp" "${outdir}/specializations.impala" COPYONLY)
+    configure_file("${outdir}/specializations.inc.tmp" "${outdir}/specializations.inc" COPYONLY)
+
+    message(STATUS "Specialized scoring configurations: ${num}")
+
+endfunction()
@@ -27,6 +27,22 @@ make -j $threads
 cd ..
 
 
+rm -rf build_avx2
+mkdir build_avx2
+cd build_avx2
+cmake .. -DAnyDSL_runtime_DIR:PATH=$runtime -DBACKEND=avx2
+make -j $threads
+cd ..
+
+
+rm -rf build_avx512
+mkdir build_avx512
+cd build_avx512
+cmake .. -DAnyDSL_runtime_DIR:PATH=$runtime -DBACKEND=avx512
+make -j $threads
+cd ..
+
+
 rm -rf build_cuda
 mkdir build_cuda
 cd build_cuda
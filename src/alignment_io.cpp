@@ -2,6 +2,7 @@
 #include <cstring>
 #include <algorithm>
 #include <iterator>
+#include <string>
 
 #include "alignment_io.h"
 
@@ -18,8 +19,7 @@ void print_alignment(std::ostream& os,
 {
     os << score << '\n';
 
-    // std::size_t n = q.find(' ');
-    std::size_t n = q.size();
+    std::size_t n = std::min(q.size(), s.size());
 
     for(std::size_t i = 0, j = 0; i < n; i += maxWidth) {
         j = std::min(n, i + maxWidth);
@@ -38,4 +38,32 @@ void print_alignment(std::ostream& os,
 }
 
 
+//-------------------------------------------------------------------
+std::string cigar_string(const std::uint32_t* ops, int numOps)
+{
+    // BAM operation codes
+    constexpr char symbols[] = "MIDNSHP=X";
+
+    std::string s;
+    for(int i = 0; i < numOps; ++i) {
+        const auto op = ops[i] & 0xf;
+        s += std::to_string(ops[i] >> 4);
+        s += op < 9 ? symbols[op] : '?';
+    }
+    return s;
+}
+
+
+//-------------------------------------------------------------------
+void print_cigar_alignment(std::ostream& os,
+                           score_t score, 
+                           const std::uint32_t* ops, const int* info)
+{
+    os << score << '\n'
+       << "query "   << info[1] << ".." << info[3] << ", "
+       << "subject " << info[2] << ".." << info[4] << '\n'
+       << cigar_string(ops, info[0]) << "\n\n";
+}
+
+
 } //namespace anyseq
@@ -1,6 +1,7 @@
 #ifndef ANYSEQ_ALIGNMENT_IO_H_
 #define ANYSEQ_ALIGNMENT_IO_H_
 
+#include <cstdint>
 #include <string>
 #include <iosfwd>
 
@@ -16,6 +17,16 @@ void print_alignment(std::ostream& os,
                      std::size_t maxWidth = 80);
 
 
+/// @brief CIGAR string (e.g. "12=1X3I") from BAM encoded operations
+std::string cigar_string(const std::uint32_t* ops, int numOps);
+
+/// @brief prints score, aligned regions (begin..end, 0-based, exclusive end)
+///        and CIGAR string; 'info' as filled by construct_*_alignment_cigar
+void print_cigar_alignment(std::ostream& os,
+                           score_t score, 
+                           const std::uint32_t* ops, const int* info);
+
+
 } // namespace anyseq 
 
 
@@ -1,14 +1,17 @@
 /**
- * pure C interface to concurrent queues
+ * pure C interface to the work-stealing tile scheduler
  **/
 
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
-
-#include "concurrent_queue.h"
-#include "dynamic_matrix.h"
-// #include "concurrent_queue_blocking.h"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 extern "C" {
@@ -26,214 +29,536 @@ struct IterBlock {
 
 
 //-----------------------------------------------------------------------------
-class dependency_tracker
+/// @brief minimal test-and-test-and-set lock for short critical sections
+class spin_lock
+{
+public:
+    void lock() noexcept {
+        while(flag_.exchange(true, std::memory_order_acquire)) {
+            while(flag_.load(std::memory_order_relaxed)) {}
+        }
+    }
+    bool try_lock() noexcept {
+        return !flag_.load(std::memory_order_relaxed) &&
+               !flag_.exchange(true, std::memory_order_acquire);
+    }
+    void unlock() noexcept {
+        flag_.store(false, std::memory_order_release);
+    }
+private:
+    std::atomic<bool> flag_ {false};
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief tile deque and parking slot of one worker thread
+ *
+ * The owner pushes and pops at the back (LIFO, keeps freshly unlocked
+ * neighbour tiles cache-hot), thieves take from the front.
+ * Slots are allocated separately to keep them on different cache lines.
+ *
+ *****************************************************************************/
+struct worker_slot
 {
-    enum class status { untouched = 0, queued = 1, complete = 2 };
+    spin_lock lock;
+    std::deque<IterBlock> tiles;
+
+    std::mutex parkMtx;
+    std::condition_variable parkCond;
+    bool parked = false;
+    bool wakeup = false;
+
+    std::uint32_t rng = 0;
+
+    // xorshift; only used by the owner to pick steal victims
+    std::uint32_t next_random() noexcept {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+};
 
-    struct atomic_status {
-        std::atomic<status> a_;
 
-        atomic_status() noexcept : a_{status::untouched} {}
 
-        atomic_status(const std::atomic<status>& a) noexcept : a_{a.load()} {}
+/*************************************************************************//**
+ *
+ * @brief tile geometry of one matrix (or of several equally sized, 
+ *        independent matrices stacked along dimension 0); 
+ *        tile (i,j) depends on (i-1,j) and (i,j-1) which also covers 
+ *        its upper left corner (i-1,j-1)
+ *
+ *****************************************************************************/
+struct tile_grid
+{
+    tile_grid(int length0, int length1, int blockdim0, int blockdim1, 
+              int num_grids = 1):
+        length0{length0 > 0 ? length0 : 0}, 
+        length1{length1 > 0 ? length1 : 0},
+        dim0{blockdim0 > 0 ? blockdim0 : 1}, 
+        dim1{blockdim1 > 0 ? blockdim1 : 1},
+        blocks0{(this->length0 + dim0 - 1) / dim0},
+        blocks1{(this->length1 + dim1 - 1) / dim1},
+        grids{num_grids > 0 ? num_grids : 1}
+    {}
+
+    int diagonals() const noexcept { 
+        return blocks0 > 0 && blocks1 > 0 ? blocks0 + blocks1 - 1 : 0; 
+    }
+    /// @brief maximum number of tiles in one antidiagonal of one grid
+    int max_diagonal_size() const noexcept { 
+        return std::min(blocks0, blocks1); 
+    }
 
-        atomic_status(status s) noexcept : a_{s} {}
+    /// @brief first block row in antidiagonal d
+    int first_row(int d) const noexcept { return std::max(0, d - blocks1 + 1); }
 
-        atomic_status(const atomic_status& src) noexcept : a_{src.a_.load()} {}
+    int diagonal_size(int d) const noexcept { 
+        return std::min(d, blocks0 - 1) - first_row(d) + 1; 
+    }
 
-        explicit operator status () const noexcept { return a_.load(); }
+    bool contains(int i, int j) const noexcept {
+        return i >= 0 && j >= 0 && i < grids * blocks0 && j < blocks1;
+    }
 
-        atomic_status& operator = (const atomic_status& src) noexcept {
-            a_.store(src.a_.load());
-            return *this;
-        }
-    };
+    /// @brief i: block row over all stacked grids
+    IterBlock block(int i, int j) const noexcept {
+        const int s0 = (i % blocks0) * dim0;
+        const int s1 = j * dim1;
+        return IterBlock{ i, j, s0, s1, 
+                          std::min(dim0, length0 - s0), 
+                          std::min(dim1, length1 - s1) };
+    }
 
-    using matrix_type = am::dynamic_matrix<atomic_status>;
+    int length0, length1;
+    int dim0, dim1;
+    int blocks0, blocks1;
+    int grids;
+};
 
-public:
-    using size_type  = matrix_type::size_type;
-    
-    dependency_tracker() = default;
 
+
+/*************************************************************************//**
+ *
+ * @brief atomic counters of unfinished predecessors per tile;
+ *        whichever thread brings a counter to zero owns the tile
+ *
+ * Counters only exist for a rolling window of antidiagonals, so memory is 
+ * O(window * tiles per antidiagonal) instead of O(all tiles).
+ * An antidiagonal is only complete once all of its predecessors are, 
+ * so the window base can simply advance diagonal by diagonal. 
+ * Successors that lie beyond the window (a few rows racing ahead) are 
+ * deferred until it has advanced far enough.
+ *
+ *****************************************************************************/
+class dependency_window
+{
+public:
     explicit
-    dependency_tracker(size_type rows, size_type cols): m_{} {
-        m_.resize(rows, cols, status::untouched);
+    dependency_window(const tile_grid& grid, int window):
+        grid_(grid),
+        window_{std::max(1, std::min(window, grid.diagonals()))},
+        counters_(std::size_t(window_) * grid.grids * grid.max_diagonal_size()),
+        remaining_(window_),
+        base_{0},
+        deferred_{}
+    {
+        for(int d = 0; d < window_; ++d) init_diagonal(d);
+    }
+
+    //---------------------------------------------------------------
+    /// @brief marks tile (i,j) as complete and 
+    ///        calls 'ready(i,j)' for every successor that became ready
+    template<class ReadyFn>
+    void complete(int i, int j, ReadyFn&& ready)
+    {
+        const int li = i % grid_.blocks0;
+        if(li + 1 < grid_.blocks0) release(i + 1, j, ready);
+        if(j  + 1 < grid_.blocks1) release(i, j + 1, ready);
+
+        // must be the last access to this tile's diagonal
+        if(remaining_[(li + j) % window_].fetch_sub(1) == 1) {
+            advance(ready);
+        }
     }
 
-    void mark_scheduled(size_type row, size_type col) {
-        m_(row, col) = status::complete; 
+private:
+    //---------------------------------------------------------------
+    // antidiagonal of a tile within its grid
+    int diagonal(int i, int j) const noexcept {
+        return (i % grid_.blocks0) + j;
     }
 
-    void mark_complete(size_type row, size_type col) {
-        m_(row, col) = status::queued; 
+    std::atomic<int>& counter(int i, int j) noexcept {
+        const int g = i / grid_.blocks0;
+        const int d = diagonal(i, j);
+        const std::size_t n = grid_.max_diagonal_size();
+        return counters_[(std::size_t(d % window_) * grid_.grids + g) * n
+                         + (i - g * grid_.blocks0 - grid_.first_row(d))];
     }
 
-    bool is_complete(size_type row, size_type col) const noexcept {
-        return status(m_(row,col)) == status::complete;
+    void init_diagonal(int d) noexcept {
+        const int n = grid_.diagonal_size(d);
+        const int lo = grid_.first_row(d);
+        for(int g = 0; g < grid_.grids; ++g) {
+            for(int k = 0; k < n; ++k) {
+                const int i = lo + k;
+                const int j = d - i;
+                counter(g * grid_.blocks0 + i, j).store(
+                    int(i > 0) + int(j > 0), std::memory_order_relaxed);
+            }
+        }
+        remaining_[d % window_].store(n * grid_.grids);
     }
 
-    bool is_queued(size_type row, size_type col) const noexcept {
-        return status(m_(row,col)) == status::queued;
+    //---------------------------------------------------------------
+    template<class ReadyFn>
+    void release(int i, int j, ReadyFn& ready)
+    {
+        const int d = diagonal(i, j);
+        if(d >= base_.load() + window_) {
+            std::lock_guard<std::mutex> lock {mtx_};
+            // re-check: the window might have moved in the meantime
+            if(d >= base_.load() + window_) {
+                deferred_.push_back({i, j});
+                return;
+            }
+        }
+        if(counter(i, j).fetch_sub(1) == 1) ready(i, j);
     }
 
-    bool is_untouched(size_type row, size_type col) const noexcept {
-        return status(m_(row,col)) == status::untouched;
+    //---------------------------------------------------------------
+    template<class ReadyFn>
+    void advance(ReadyFn& ready)
+    {
+        std::vector<std::pair<int,int>> replay;
+        {
+            std::lock_guard<std::mutex> lock {mtx_};
+            int base = base_.load();
+            while(base < grid_.diagonals() && 
+                  remaining_[base % window_].load() == 0) 
+            {
+                if(base + window_ < grid_.diagonals()) {
+                    init_diagonal(base + window_);
+                }
+                ++base;
+                base_.store(base);
+            }
+            auto keep = deferred_.begin();
+            for(const auto& t : deferred_) {
+                if(diagonal(t.first, t.second) < base + window_) {
+                    replay.push_back(t);
+                } else {
+                    *keep++ = t;
+                }
+            }
+            deferred_.erase(keep, deferred_.end());
+        }
+        for(const auto& t : replay) {
+            if(counter(t.first, t.second).fetch_sub(1) == 1) {
+                ready(t.first, t.second);
+            }
+        }
     }
 
-private:
-    matrix_type m_;
+
+    const tile_grid& grid_;
+    int window_;
+    std::vector<std::atomic<int>> counters_;
+    std::vector<std::atomic<int>> remaining_;
+    std::atomic<int> base_;
+    std::mutex mtx_;
+    std::vector<std::pair<int,int>> deferred_;
 };
 
 
+
 //-----------------------------------------------------------------------------
-// global state
+// per-alignment state
 //-----------------------------------------------------------------------------
-using queue_type = moodycamel::ConcurrentQueue<IterBlock>;
-// using queue_type = moodycamel::BlockintConcurrentQueue<IterBlock>;
 
-int batchSize = 8;
-std::atomic<bool> completed {false};
+/*************************************************************************//**
+ *
+ * @brief all state of one queue-driven alignment;
+ *        handed to the Impala side as an opaque pointer so that any number
+ *        of alignments can run concurrently in one process
+ *
+ * 'outstanding' counts tiles that are either queued or being processed;
+ * the alignment is complete as soon as it drops to zero.
+ *
+ *****************************************************************************/
+struct QueueContext
+{
+    // polling rounds before an idle worker yields / parks
+    static constexpr int spin_rounds  = 256;
+    static constexpr int yield_rounds = 16;
 
-std::mutex batchMtx;
-std::mutex completeMtx;
-std::condition_variable batchReadyCond;
-std::condition_variable completeCond;
-dependency_tracker dependencies;
-queue_type queue;
+    explicit
+    QueueContext(int batch_size, int num_workers, 
+                 const tile_grid& tiles):
+        batchSize{batch_size > 0 ? batch_size : 8},
+        grid{tiles},
+        dependencies(grid, 4 * std::max(num_workers, 1) + 4),
+        workers{}
+    {
+        if(num_workers < 1) num_workers = 1;
+        workers.reserve(num_workers);
+        for(int i = 0; i < num_workers; ++i) {
+            workers.emplace_back(new worker_slot{});
+            workers.back()->rng = 2654435761u * std::uint32_t(i + 1);
+        }
+    }
 
-inline bool batch_ready() {
-    return int(queue.size_approx()) >= batchSize;
-}
+    int num_workers() const noexcept { return int(workers.size()); }
 
+    bool complete() const noexcept {
+        return completed.load() || outstanding.load() == 0;
+    }
 
-extern "C" {
+    //---------------------------------------------------------------
+    void push(int w, const IterBlock& tile)
+    {
+        // seeding from outside of a worker: distribute round robin
+        if(w < 0 || w >= num_workers()) {
+            w = int(nextSeed++ % unsigned(num_workers()));
+        }
+        outstanding.fetch_add(1);
+        auto& slot = *workers[w];
+        slot.lock.lock();
+        slot.tiles.push_back(tile);
+        slot.lock.unlock();
+        queued.fetch_add(1);
+
+        if(sleepers.load() > 0) wake_one(w);
+    }
 
-//-----------------------------------------------------------------------------
-void initialize_queue(int batch_size, int blocks0, int blocks1) 
-{
-    if(batch_size > 0) {
-        batchSize = batch_size;
+    //---------------------------------------------------------------
+    int pop(int w, IterBlock* tiles, int n)
+    {
+        if(n < 1) return 0;
+        int k = 0;
+        if(w >= 0 && w < num_workers()) {
+            auto& slot = *workers[w];
+            slot.lock.lock();
+            while(k < n && !slot.tiles.empty()) {
+                tiles[k++] = slot.tiles.back();
+                slot.tiles.pop_back();
+            }
+            slot.lock.unlock();
+        }
+        if(k == 0) k = steal(w, tiles, n);
+        if(k > 0) queued.fetch_sub(k);
+        return k;
     }
-    queue = queue_type{};
-    dependencies = dependency_tracker(blocks0,blocks1);
-}
 
-void finalize_queue() {}
+    //---------------------------------------------------------------
+    // takes up to half of a randomly chosen victim's tiles
+    int steal(int w, IterBlock* tiles, int n)
+    {
+        const int nw = num_workers();
+        if(nw < 2 && w >= 0) return 0;
+        const auto r = (w >= 0 && w < nw) ? workers[w]->next_random() 
+                                          : std::uint32_t(nextSeed.load());
+        for(int i = 0; i < nw; ++i) {
+            const int v = int((r + unsigned(i)) % unsigned(nw));
+            if(v == w) continue;
+            auto& slot = *workers[v];
+            if(!slot.lock.try_lock()) continue;
+            const int avail = int(slot.tiles.size());
+            const int m = avail < 2 ? avail : std::min(n, (avail + 1) / 2);
+            for(int k = 0; k < m; ++k) {
+                tiles[k] = slot.tiles.front();
+                slot.tiles.pop_front();
+            }
+            slot.lock.unlock();
+            if(m > 0) return m;
+        }
+        return 0;
+    }
 
+    //---------------------------------------------------------------
+    void complete_tile(int w, int i, int j) {
+        dependencies.complete(i, j, [&](int si, int sj) {
+            push(w, grid.block(si, sj));
+        });
+        finish(1);
+    }
 
-//-----------------------------------------------------------------------------
-void mark_complete(int x, int y) {
-    dependencies.mark_complete(x,y);
-}
+    //---------------------------------------------------------------
+    void finish(int n) {
+        if(outstanding.fetch_sub(n) == n) {
+            completed.store(true);
+            wake_all();
+        }
+    }
 
-int is_complete(int x, int y) {
-    return int(dependencies.is_complete(x,y));
-}
-int is_queued(int x, int y) {
-    return int(dependencies.is_queued(x,y));
-}
-int is_untouched(int x, int y) {
-    return int(dependencies.is_untouched(x,y));
-}
+    //---------------------------------------------------------------
+    // spin, then yield, then park until there is work or all is done
+    bool wait_for_work(int w)
+    {
+        for(int i = 0; i < spin_rounds + yield_rounds; ++i) {
+            if(complete()) return false;
+            if(queued.load(std::memory_order_relaxed) > 0) return true;
+            if(i >= spin_rounds) std::this_thread::yield();
+        }
+        if(w < 0 || w >= num_workers()) {
+            std::this_thread::yield();
+            return !complete();
+        }
 
+        auto& slot = *workers[w];
+        std::unique_lock<std::mutex> lock {slot.parkMtx};
+        slot.parked = true;
+        slot.wakeup = false;
+        sleepers.fetch_add(1);
+        // re-check after announcing ourselves, so no wakeup can be missed
+        while(!slot.wakeup && !complete() && queued.load() == 0) {
+            slot.parkCond.wait(lock);
+        }
+        sleepers.fetch_sub(1);
+        slot.parked = false;
+        return !complete();
+    }
 
-void signal_all_complete() {
-    completed.store(true);
-}
+    //---------------------------------------------------------------
+    void wake_one(int hint) {
+        const int nw = num_workers();
+        for(int i = 1; i <= nw; ++i) {
+            auto& slot = *workers[(hint + i) % nw];
+            std::lock_guard<std::mutex> lock {slot.parkMtx};
+            if(slot.parked && !slot.wakeup) {
+                slot.wakeup = true;
+                slot.parkCond.notify_one();
+                return;
+            }
+        }
+    }
+
+    void wake_all() {
+        for(auto& w : workers) {
+            std::lock_guard<std::mutex> lock {w->parkMtx};
+            w->wakeup = true;
+            w->parkCond.notify_one();
+        }
+        std::lock_guard<std::mutex> lock {completeMtx};
+        completeCond.notify_all();
+    }
 
-int all_complete() {
-    return int(completed.load());
-}
 
+    int batchSize;
+    std::atomic<bool> completed {false};
+    std::atomic<int> outstanding {0};
+    std::atomic<int> queued {0};
+    std::atomic<int> sleepers {0};
+    std::atomic<unsigned> nextSeed {0};
+
+    std::mutex completeMtx;
+    std::condition_variable completeCond;
+    tile_grid grid;
+    dependency_window dependencies;
+    std::vector<std::unique_ptr<worker_slot>> workers;
+};
+
+
+extern "C" {
 
 //-----------------------------------------------------------------------------
-// allocates more memory if necessary
-int enqueue_single(const IterBlock* item) 
+// matrix of length0 x length1 cells, split into blockdim0 x blockdim1 tiles
+QueueContext* initialize_queue(int batch_size, int num_workers,
+                               int length0, int length1,
+                               int blockdim0, int blockdim1)
 {
-    bool success = queue.enqueue(*item);
-
-    if(success && batch_ready()) {
-        batchReadyCond.notify_one();
-    }
-    return int(success);
+    return new QueueContext{batch_size, num_workers, 
+                            tile_grid{length0, length1, blockdim0, blockdim1}};
 }
 
-int enqueue_bulk(const IterBlock* items, int n)
+// 'num_grids' independent matrices of equal size; 
+// tile (x,y) of grid g has the index (g * blocks0 + x, y)
+QueueContext* initialize_stacked_queue(int batch_size, int num_workers,
+                                       int num_grids, 
+                                       int length0, int length1,
+                                       int blockdim0, int blockdim1)
 {
-    bool success = queue.enqueue_bulk(items, n);
+    return new QueueContext{batch_size, num_workers, 
+                            tile_grid{length0, length1, blockdim0, blockdim1,
+                                      num_grids}};
+}
 
-    if(success && batch_ready()) {
-        batchReadyCond.notify_one();
-    }
-    return int(success);
+void finalize_queue(QueueContext* ctx) {
+    delete ctx;
 }
 
 
 //-----------------------------------------------------------------------------
-// fails if not enough memory to enqueue
-int try_enqueue_single(const IterBlock* item) 
-{
-    bool success = queue.try_enqueue(*item);
+void signal_all_complete(QueueContext* ctx) {
+    ctx->completed.store(true);
+    ctx->wake_all();
+}
 
-    if(success && batch_ready()) {
-        batchReadyCond.notify_one();
-    }
-    return int(success);
+int all_complete(QueueContext* ctx) {
+    return int(ctx->complete());
 }
 
-int try_enqueue_bulk(const IterBlock* items, int n)
-{
-    bool success = queue.try_enqueue_bulk(items, n);
 
-    if(success && batch_ready()) {
-        batchReadyCond.notify_one();
+//-----------------------------------------------------------------------------
+// pushes tile (x,y) onto the deque of 'worker'; 
+// worker < 0 distributes tiles over all workers
+void enqueue_tile(QueueContext* ctx, int worker, int x, int y) 
+{
+    if(ctx->grid.contains(x,y)) {
+        ctx->push(worker, ctx->grid.block(x,y));
     }
-    return int(success);
 }
 
 
 //-----------------------------------------------------------------------------
-// attempts to dequeue from the queue (never allocates)
-int try_dequeue_single(IterBlock* item)
+// marks a dequeued tile as complete and enqueues all successors 
+// for which it was the last unfinished predecessor
+void complete_tile(QueueContext* ctx, int worker, int x, int y) 
 {
-    return queue.try_dequeue(*item);
+    ctx->complete_tile(worker, x, y);
 }
 
+
+//-----------------------------------------------------------------------------
+// takes tiles from the worker's own deque or steals from another one;
 // returns actual count of dequeued items
-int try_dequeue_bulk(IterBlock* items, int n)
+int try_dequeue_single(QueueContext* ctx, int worker, IterBlock* item)
 {
-    return queue.try_dequeue_bulk(items, n);
+    return ctx->pop(worker, item, 1);
+}
+
+int try_dequeue_bulk(QueueContext* ctx, int worker, IterBlock* items, int n)
+{
+    return ctx->pop(worker, items, n);
 }
 
 
 //-----------------------------------------------------------------------------
-int queue_approx_size() {
-    return int(queue.size_approx());
+int queue_approx_size(QueueContext* ctx) {
+    return ctx->queued.load();
 }
 
 
 //-----------------------------------------------------------------------------
-void wait_until_batch_ready() 
+// returns 0 if all tiles are complete, 1 if there might be work
+int wait_for_work(QueueContext* ctx, int worker) 
 {
-    std::unique_lock<std::mutex> lock {batchMtx};
-    
-    while(!batch_ready()) {
-        batchReadyCond.wait(lock);
-    }
+    return int(ctx->wait_for_work(worker));
 }
 
 
 //-----------------------------------------------------------------------------
-void wait_until_complete() 
+void wait_until_complete(QueueContext* ctx) 
 {
-    std::unique_lock<std::mutex> lock {completeMtx};
+    std::unique_lock<std::mutex> lock {ctx->completeMtx};
     
-    while(!completed.load()) {
-        completeCond.wait(lock);
+    while(!ctx->complete()) {
+        ctx->completeCond.wait(lock);
     }
 }
 
 
 } // extern "C"
-
@@ -9,7 +9,8 @@ using index_t = std::uint64_t;
 
 
 /// @brief score storage type
+/// must match "Score" in config.impala
 // using score_t = std::int16_t;
-// using score_t = std::int32_t;
-using score_t = std::int64_t;
+using score_t = std::int32_t;
+// using score_t = std::int64_t;
 
@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <future>
+#include <thread>
+
+#include "database_search.h"
+
+
+namespace anyseq {
+
+
+//-------------------------------------------------------------------
+namespace {
+
+// heap order: worst hit on top
+bool better(const search_hit& a, const search_hit& b) noexcept
+{
+    return a.score > b.score || (a.score == b.score && a.record < b.record);
+}
+
+
+//-------------------------------------------------------------------
+struct record_batch {
+    std::vector<std::uint_least64_t> records;
+    std::vector<std::string> headers;
+    std::vector<std::string> data;
+    std::vector<const char*> seqs;
+    std::vector<int> lens;
+
+    std::size_t size() const noexcept { return seqs.size(); }
+};
+
+
+//-------------------------------------------------------------------
+record_batch read_batch(sequence_reader& db, std::size_t size,
+                        const std::function<void(std::string&)>& encode)
+{
+    record_batch b;
+    b.records.reserve(size);
+    b.headers.reserve(size);
+    b.data.reserve(size);
+
+    sequence_reader::sequence seq;
+    while(b.data.size() < size && db.has_next()) {
+        db.next(seq);
+        // empty records can't be aligned
+        if(seq.data.empty()) continue;
+        if(encode) encode(seq.data);
+        b.records.push_back(seq.index);
+        b.headers.push_back(std::move(seq.header));
+        b.data.push_back(std::move(seq.data));
+    }
+
+    b.seqs.reserve(b.data.size());
+    b.lens.reserve(b.data.size());
+    for(const auto& s : b.data) {
+        b.seqs.push_back(s.data());
+        b.lens.push_back(int(s.size()));
+    }
+    return b;
+}
+
+
+} // namespace
+
+
+
+//-------------------------------------------------------------------
+bool top_hits::qualifies(score_t score, std::uint_least64_t record) const noexcept
+{
+    if(k_ < 1) return false;
+    if(heap_.size() < k_) return true;
+    const auto& worst = heap_.front();
+    return score > worst.score || (score == worst.score && record < worst.record);
+}
+
+
+//-------------------------------------------------------------------
+void top_hits::insert(search_hit&& hit)
+{
+    if(!qualifies(hit.score, hit.record)) return;
+
+    if(heap_.size() == k_) {
+        std::pop_heap(heap_.begin(), heap_.end(), better);
+        heap_.pop_back();
+    }
+    heap_.push_back(std::move(hit));
+    std::push_heap(heap_.begin(), heap_.end(), better);
+}
+
+
+//-------------------------------------------------------------------
+std::vector<search_hit> top_hits::sorted() &&
+{
+    std::sort_heap(heap_.begin(), heap_.end(), better);
+    return std::move(heap_);
+}
+
+
+
+//-------------------------------------------------------------------
+std::vector<std::vector<search_hit>>
+search_database(const std::vector<std::string>& queries, 
+                sequence_reader& db,
+                const search_kernels& kernels,
+                const search_options& opt)
+{
+    const auto batchSize = std::max(std::size_t(1), opt.batchSize);
+
+    std::vector<top_hits> best(queries.size(), top_hits{opt.topK});
+    std::vector<score_t> scores;
+
+    // score only: the next batch is read while the current one is scored
+    auto next = std::async(std::launch::async, [&] {
+        return read_batch(db, batchSize, kernels.encode); });
+
+    while(true) {
+        auto batch = next.get();
+        if(batch.size() < 1) break;
+
+        next = std::async(std::launch::async, [&] {
+            return read_batch(db, batchSize, kernels.encode); });
+
+        scores.resize(batch.size());
+        for(std::size_t q = 0; q < queries.size(); ++q) {
+            const auto& query = queries[q];
+            if(query.empty()) continue;
+
+            kernels.score(query.data(), int(query.size()), 
+                          batch.seqs.data(), batch.lens.data(),
+                          int(batch.size()), scores.data());
+
+            for(std::size_t i = 0; i < batch.size(); ++i) {
+                if(!best[q].qualifies(scores[i], batch.records[i])) continue;
+                search_hit hit;
+                hit.score   = scores[i];
+                hit.record  = batch.records[i];
+                hit.header  = batch.headers[i];
+                hit.subject = batch.data[i];
+                best[q].insert(std::move(hit));
+            }
+        }
+    }
+
+    // tracebacks only for the final hits
+    std::vector<std::vector<search_hit>> results;
+    results.reserve(queries.size());
+
+    for(std::size_t q = 0; q < queries.size(); ++q) {
+        auto hits = std::move(best[q]).sorted();
+        const auto& query = queries[q];
+
+        if(kernels.align) {
+            for(auto& hit : hits) {
+                const auto alen = query.size() + hit.subject.size();
+                hit.alignedQuery.resize(alen);
+                hit.alignedSubject.resize(alen);
+                int info[3] = {0};
+                kernels.align(query.data(), int(query.size()),
+                              hit.subject.data(), int(hit.subject.size()),
+                              &hit.alignedQuery[0], &hit.alignedSubject[0],
+                              int(alen), info);
+                hit.alignedQuery.resize(info[0]);
+                hit.alignedSubject.resize(info[0]);
+                hit.queryBegin = info[1];
+                hit.subjectBegin = info[2];
+            }
+        }
+        results.push_back(std::move(hits));
+    }
+
+    return results;
+}
+
+
+} // namespace anyseq
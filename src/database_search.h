@@ -0,0 +1,123 @@
+#ifndef ANYSEQ_DATABASE_SEARCH_H_
+#define ANYSEQ_DATABASE_SEARCH_H_
+
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "sequence_io.h"
+
+
+namespace anyseq {
+
+
+/*************************************************************************//**
+ *
+ * @brief database record that scored among the best for a query
+ *
+ *****************************************************************************/
+struct search_hit {
+    score_t score = 0;
+    std::uint_least64_t record = 0;  //position of the record in the database
+    std::string header;
+    std::string subject;             //encoded sequence
+    std::string alignedQuery;        //only filled for the final hits
+    std::string alignedSubject;
+    int queryBegin = 0;              //first aligned positions
+    int subjectBegin = 0;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief keeps the k best hits (min-heap on score);
+ *        of equally scoring hits the ones from earlier records are kept
+ *
+ *****************************************************************************/
+class top_hits
+{
+public:
+    explicit
+    top_hits(std::size_t k = 10): k_{k} {}
+
+    std::size_t capacity() const noexcept { return k_; }
+    std::size_t size() const noexcept { return heap_.size(); }
+
+    /** @brief true, if a hit with this score and record would be kept */
+    bool qualifies(score_t score, std::uint_least64_t record) const noexcept;
+
+    void insert(search_hit&&);
+
+    /** @brief best hit first */
+    std::vector<search_hit> sorted() &&;
+
+private:
+    std::size_t k_;
+    std::vector<search_hit> heap_;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief kernels used by 'search_database'
+ *
+ *****************************************************************************/
+struct search_kernels {
+    /// scores one query against a batch of subjects
+    /// (e.g. local_alignment_score_search)
+    std::function<void(const char* query, int lenq, 
+                       const char* const* subjects, const int* lens,
+                       int numSubjects, score_t* scores)> score;
+
+    /// constructs one alignment (e.g. construct_local_alignment);
+    /// only called for the final hits
+    std::function<score_t(const char* query, int lenq, 
+                          const char* subject, int lens,
+                          char* alQuery, char* alSubject, int alCapacity, int* alInfo)> align;
+
+    /// encodes database records (e.g. encode_dna)
+    std::function<void(std::string&)> encode;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief search parameters
+ *
+ *****************************************************************************/
+struct search_options {
+    std::size_t topK = 10;
+    std::size_t batchSize = 4096;   //database records per kernel call
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief scores every query against every database record (score only),
+ *        keeps the 'topK' best hits per query and constructs alignments 
+ *        for those only; the next batch of records is read while 
+ *        the current one is being scored
+ *
+ * @param queries  encoded query sequences
+ *
+ * @return hits for each query, best first
+ *
+ *****************************************************************************/
+std::vector<std::vector<search_hit>>
+search_database(const std::vector<std::string>& queries, 
+                sequence_reader& database,
+                const search_kernels&,
+                const search_options& = search_options{});
+
+
+} // namespace anyseq
+
+
+#endif
@@ -0,0 +1,105 @@
+#include "dispatch.h"
+#include "import.h"
+
+
+namespace anyseq {
+
+
+namespace {
+
+//-------------------------------------------------------------------
+using score_fn = score_t(*)(const char*, int, const char*, int);
+using construct_fn = score_t(*)(const char*, int, const char*, int, char*, char*, int, int*);
+
+struct specialization {
+    alignment_type type;
+    linear_scoring_params params;
+    score_fn score;
+    construct_fn construct;
+};
+
+// generated by cmake/specializations.cmake
+#include "specializations.inc"
+
+
+//-------------------------------------------------------------------
+inline bool
+operator == (const linear_scoring_params& a, const linear_scoring_params& b)
+{
+    return a.match == b.match && a.mismatch == b.mismatch && a.gap == b.gap;
+}
+
+
+//-------------------------------------------------------------------
+const specialization*
+find_specialization(alignment_type type, const linear_scoring_params& params)
+{
+    for(const auto& s : specializations) {
+        if(s.score && s.type == type && s.params == params) return &s;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+
+
+//-------------------------------------------------------------------
+bool is_specialized(alignment_type type, const linear_scoring_params& params)
+{
+    return find_specialization(type, params) != nullptr;
+}
+
+
+
+//-------------------------------------------------------------------
+score_t alignment_score(alignment_type type, 
+                        const linear_scoring_params& p,
+                        const char* q, int lq, 
+                        const char* s, int ls)
+{
+    auto spec = find_specialization(type, p);
+    if(spec) return spec->score(q, lq, s, ls);
+
+    switch(type) {
+        default:
+        case alignment_type::global:
+            return global_alignment_score_linear(q, lq, s, ls, 
+                                                 p.match, p.mismatch, p.gap);
+        case alignment_type::semiglobal:
+            return semiglobal_alignment_score_linear(q, lq, s, ls, 
+                                                     p.match, p.mismatch, p.gap);
+        case alignment_type::local:
+            return local_alignment_score_linear(q, lq, s, ls, 
+                                                p.match, p.mismatch, p.gap);
+    }
+}
+
+
+
+//-------------------------------------------------------------------
+score_t construct_alignment(alignment_type type, 
+                            const linear_scoring_params& p,
+                            const char* q, int lq, 
+                            const char* s, int ls,
+                            char* alq, char* als, int cap, int* info)
+{
+    auto spec = find_specialization(type, p);
+    if(spec) return spec->construct(q, lq, s, ls, alq, als, cap, info);
+
+    switch(type) {
+        default:
+        case alignment_type::global:
+            return construct_global_alignment_linear(q, lq, s, ls, alq, als, cap, info,
+                                                     p.match, p.mismatch, p.gap);
+        case alignment_type::semiglobal:
+            return construct_semiglobal_alignment_linear(q, lq, s, ls, alq, als, cap, info,
+                                                         p.match, p.mismatch, p.gap);
+        case alignment_type::local:
+            return construct_local_alignment_linear(q, lq, s, ls, alq, als, cap, info,
+                                                    p.match, p.mismatch, p.gap);
+    }
+}
+
+
+} // namespace anyseq
@@ -0,0 +1,80 @@
+#ifndef ANYSEQ_DISPATCH_H_
+#define ANYSEQ_DISPATCH_H_
+
+
+#include "config.h"
+
+
+namespace anyseq {
+
+
+/*************************************************************************//**
+ *
+ * @brief alignment types with runtime dispatch support
+ *
+ *****************************************************************************/
+enum class alignment_type {
+    global, semiglobal, local
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief linear gap scoring parameters
+ *
+ *****************************************************************************/
+struct linear_scoring_params {
+    score_t match = 2;
+    score_t mismatch = -1;
+    score_t gap = -1;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief returns true, if a partially evaluated kernel was generated 
+ *        for the given alignment type and scoring parameters at build time
+ *
+ *****************************************************************************/
+bool is_specialized(alignment_type, const linear_scoring_params&);
+
+
+
+/*************************************************************************//**
+ *
+ * @brief computes an alignment score; 
+ *        uses a specialized kernel if available and 
+ *        the runtime-parameterized kernel otherwise;
+ *        query/subject must be encoded with 'encode_dna'
+ *
+ *****************************************************************************/
+score_t alignment_score(alignment_type, const linear_scoring_params&,
+                        const char* query, int lenq, 
+                        const char* subject, int lens);
+
+
+
+/*************************************************************************//**
+ *
+ * @brief constructs an alignment (linear memory traceback); 
+ *        uses a specialized kernel if available and 
+ *        the runtime-parameterized kernel otherwise;
+ *        query/subject must be encoded with 'encode_dna';
+ *        the alignment is written from index 0 of alQuery/alSubject
+ *        (alCapacity chars each; lenq+lens always suffices),
+ *        alInfo[3] receives its length and begin in query and subject;
+ *        a length beyond alCapacity means the outputs were truncated
+ *
+ *****************************************************************************/
+score_t construct_alignment(alignment_type, const linear_scoring_params&,
+                            const char* query, int lenq, 
+                            const char* subject, int lens, 
+                            char* alQuery, char* alSubject, int alCapacity, int* alInfo);
+
+
+} // namespace anyseq
+
+
+#endif
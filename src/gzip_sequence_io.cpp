@@ -0,0 +1,509 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+#include "io_error.h"
+#include "threading.h"
+#include "gzip_sequence_io.h"
+
+
+namespace anyseq {
+
+using std::string;
+
+
+namespace detail {
+
+/*************************************************************************//**
+ *
+ * @brief runs a chunk producer on a background thread;
+ *        the consumer gets filled chunks in order while the producer 
+ *        already fills the next free one (2 buffers = double buffering)
+ *
+ *****************************************************************************/
+class chunk_pipeline
+{
+public:
+    using producer = std::function<bool(std::vector<char>&)>;
+
+    explicit
+    chunk_pipeline(producer produce, int buffers = 2):
+        produce_{std::move(produce)},
+        buffers_(std::max(buffers, 2)),
+        current_{nullptr}
+    {
+        for(auto& b : buffers_) free_.push_back(&b);
+        thread_ = std::thread{[this] { run(); }};
+    }
+
+    ~chunk_pipeline() {
+        {
+            std::lock_guard<std::mutex> lock {mtx_};
+            stop_ = true;
+        }
+        cond_.notify_all();
+        if(thread_.joinable()) thread_.join();
+    }
+
+    //---------------------------------------------------------------
+    bool next(const char*& begin, const char*& end) 
+    {
+        std::unique_lock<std::mutex> lock {mtx_};
+        // chunk handed out last time is no longer in use
+        if(current_) {
+            free_.push_back(current_);
+            current_ = nullptr;
+            cond_.notify_all();
+        }
+        cond_.wait(lock, [this] { return !filled_.empty() || done_; });
+
+        if(filled_.empty()) {
+            if(error_) std::rethrow_exception(error_);
+            return false;
+        }
+        current_ = filled_.front();
+        filled_.pop_front();
+        begin = current_->data();
+        end = begin + current_->size();
+        return true;
+    }
+
+private:
+    //---------------------------------------------------------------
+    void run() 
+    {
+        try {
+            while(true) {
+                std::vector<char>* buf = nullptr;
+                {
+                    std::unique_lock<std::mutex> lock {mtx_};
+                    cond_.wait(lock, [this] { return !free_.empty() || stop_; });
+                    if(stop_) break;
+                    buf = free_.front();
+                    free_.pop_front();
+                }
+                const bool more = produce_(*buf);
+                {
+                    std::lock_guard<std::mutex> lock {mtx_};
+                    if(!buf->empty()) filled_.push_back(buf);
+                    else free_.push_back(buf);
+                    if(!more) done_ = true;
+                }
+                cond_.notify_all();
+                if(!more) return;
+            }
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lock {mtx_};
+            error_ = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock {mtx_};
+            done_ = true;
+        }
+        cond_.notify_all();
+    }
+
+
+    producer produce_;
+    std::vector<std::vector<char>> buffers_;
+    std::deque<std::vector<char>*> free_;
+    std::deque<std::vector<char>*> filled_;
+    std::vector<char>* current_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+    bool done_ = false;
+    std::exception_ptr error_;
+    std::thread thread_;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief persistent helper threads for running 'count' independent jobs;
+ *        the calling thread participates
+ *
+ *****************************************************************************/
+class job_pool
+{
+public:
+    explicit
+    job_pool(int threads) 
+    {
+        for(int i = 1; i < threads; ++i) {
+            threads_.emplace_back([this] { work(); });
+        }
+    }
+
+    ~job_pool() {
+        {
+            std::lock_guard<std::mutex> lock {mtx_};
+            stop_ = true;
+        }
+        cond_.notify_all();
+        for(auto& t : threads_) t.join();
+    }
+
+    void run(int count, const std::function<void(int)>& job) 
+    {
+        {
+            std::lock_guard<std::mutex> lock {mtx_};
+            job_ = &job;
+            count_ = count;
+            next_.store(0);
+            busy_ = int(threads_.size());
+            ++generation_;
+        }
+        cond_.notify_all();
+        process();
+
+        std::unique_lock<std::mutex> lock {mtx_};
+        doneCond_.wait(lock, [this] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void process() {
+        for(int i = next_++; i < count_; i = next_++) (*job_)(i);
+    }
+
+    void work() {
+        std::uint64_t seen = 0;
+        while(true) {
+            {
+                std::unique_lock<std::mutex> lock {mtx_};
+                cond_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if(stop_) return;
+                seen = generation_;
+            }
+            process();
+            {
+                std::lock_guard<std::mutex> lock {mtx_};
+                --busy_;
+            }
+            doneCond_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    std::condition_variable doneCond_;
+    const std::function<void(int)>* job_ = nullptr;
+    int count_ = 0;
+    std::atomic<int> next_ {0};
+    int busy_ = 0;
+    std::uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace detail
+
+
+
+namespace {
+
+//-------------------------------------------------------------------
+std::ifstream open_compressed(const string& filename)
+{
+    std::ifstream is {filename, std::ios::in | std::ios::binary};
+    if(!is.good()) {
+        throw file_access_error{"can't open file " + filename};
+    }
+    return is;
+}
+
+
+//-------------------------------------------------------------------
+inline unsigned read_u16(const unsigned char* p) noexcept {
+    return unsigned(p[0]) | (unsigned(p[1]) << 8);
+}
+
+inline std::uint32_t read_u32(const unsigned char* p) noexcept {
+    return std::uint32_t(read_u16(p)) | (std::uint32_t(read_u16(p+2)) << 16);
+}
+
+
+//-------------------------------------------------------------------
+// returns the total size of a BGZF block given its first 18 bytes 
+// or 0 if the header doesn't belong to a BGZF block
+std::size_t bgzf_block_size(const unsigned char* h)
+{
+    if(h[0] != 31 || h[1] != 139 || h[2] != 8 || !(h[3] & 4)) return 0;
+    // only the layout written by bgzip is recognized (BC is the first 
+    // extra subfield); a file with other subfields before BC is read 
+    // by the sequential gzip reader instead
+    if(h[12] == 'B' && h[13] == 'C' && read_u16(h + 14) == 2) {
+        return std::size_t(read_u16(h + 16)) + 1;
+    }
+    return 0;
+}
+
+
+
+/*************************************************************************//**
+ *
+ * @brief streaming inflate of (multi-member) gzip files
+ *
+ *****************************************************************************/
+class gzip_inflater
+{
+public:
+    gzip_inflater(const string& filename, std::size_t chunkSize):
+        file_{open_compressed(filename)},
+        in_(1 << 20),
+        chunkSize_{chunkSize > 0 ? chunkSize : (1 << 16)},
+        filename_{filename}
+    {
+        std::memset(&strm_, 0, sizeof(strm_));
+        // 15 + 32: zlib and gzip headers
+        if(inflateInit2(&strm_, 15 + 32) != Z_OK) {
+            throw io_error{"can't initialize zlib for " + filename};
+        }
+    }
+
+    ~gzip_inflater() { inflateEnd(&strm_); }
+
+    gzip_inflater(const gzip_inflater&) = delete;
+    gzip_inflater& operator = (const gzip_inflater&) = delete;
+
+    //---------------------------------------------------------------
+    bool operator () (std::vector<char>& out) 
+    {
+        out.resize(chunkSize_);
+        strm_.next_out  = reinterpret_cast<Bytef*>(out.data());
+        strm_.avail_out = uInt(out.size());
+
+        while(strm_.avail_out > 0) {
+            if(strm_.avail_in == 0) {
+                if(!file_.good()) break;
+                file_.read(reinterpret_cast<char*>(in_.data()), 
+                           std::streamsize(in_.size()));
+                const auto n = file_.gcount();
+                if(n <= 0) break;
+                strm_.next_in  = in_.data();
+                strm_.avail_in = uInt(n);
+            }
+            inMember_ = true;
+            const int ret = inflate(&strm_, Z_NO_FLUSH);
+            if(ret == Z_STREAM_END) {
+                // concatenated gzip members
+                inflateReset(&strm_);
+                inMember_ = false;
+            }
+            else if(ret != Z_OK && ret != Z_BUF_ERROR) {
+                throw io_format_error{"corrupt gzip data in " + filename_};
+            }
+        }
+        // end of file inside a member
+        if(inMember_ && strm_.avail_in == 0 && !file_.good()) {
+            throw io_format_error{"truncated gzip data in " + filename_};
+        }
+        out.resize(out.size() - strm_.avail_out);
+
+        return strm_.avail_in > 0 || file_.good();
+    }
+
+private:
+    std::ifstream file_;
+    std::vector<Bytef> in_;
+    std::size_t chunkSize_;
+    z_stream strm_;
+    string filename_;
+    // member started, but its end (Z_STREAM_END) not seen yet
+    bool inMember_ = false;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief reads batches of BGZF blocks and inflates them in parallel
+ *        directly into their final position (known from the ISIZE footer)
+ *
+ *****************************************************************************/
+class bgzf_inflater
+{
+    struct block {
+        std::size_t in;     // offset of deflate payload in 'in_'
+        std::size_t inSize;
+        std::size_t out;    // offset of inflated data in chunk
+        std::size_t outSize;
+    };
+
+public:
+    bgzf_inflater(const string& filename, int threads, std::size_t chunkSize):
+        file_{open_compressed(filename)},
+        chunkSize_{chunkSize > 0 ? chunkSize : (1 << 16)},
+        pool_{threads > 0 ? threads : std::min(4, thread_count())},
+        filename_{filename}
+    {}
+
+    //---------------------------------------------------------------
+    bool operator () (std::vector<char>& out) 
+    {
+        in_.clear();
+        blocks_.clear();
+        std::size_t total = 0;
+        bool more = true;
+
+        while(total < chunkSize_) {
+            if(!read_block(total)) { more = false; break; }
+            total += blocks_.back().outSize;
+        }
+
+        out.resize(total);
+        std::atomic<bool> failed {false};
+
+        pool_.run(int(blocks_.size()), [&](int i) {
+            const auto& b = blocks_[i];
+            if(!inflate_block(b, out.data() + b.out)) failed = true;
+        });
+
+        if(failed) {
+            throw io_format_error{"corrupt BGZF block in " + filename_};
+        }
+        return more;
+    }
+
+private:
+    //---------------------------------------------------------------
+    bool read_block(std::size_t outOffset)
+    {
+        unsigned char h[18];
+        file_.read(reinterpret_cast<char*>(h), 18);
+        if(file_.gcount() == 0) return false;
+        if(file_.gcount() < 18) {
+            throw io_format_error{"truncated BGZF block in " + filename_};
+        }
+        const auto size = bgzf_block_size(h);
+        const auto xlen = read_u16(h + 10);
+        if(size < std::size_t(12 + xlen + 8)) {
+            throw io_format_error{"not a BGZF block in " + filename_};
+        }
+        const auto offset = in_.size();
+        in_.resize(offset + size);
+        std::memcpy(in_.data() + offset, h, 18);
+        file_.read(reinterpret_cast<char*>(in_.data() + offset + 18), 
+                   std::streamsize(size - 18));
+        if(std::size_t(file_.gcount()) != size - 18) {
+            throw io_format_error{"truncated BGZF block in " + filename_};
+        }
+        block b;
+        b.in      = offset + 12 + xlen;
+        b.inSize  = size - 12 - xlen - 8;
+        b.out     = outOffset;
+        b.outSize = read_u32(in_.data() + offset + size - 4);
+        blocks_.push_back(b);
+        return true;
+    }
+
+    //---------------------------------------------------------------
+    bool inflate_block(const block& b, char* out) const
+    {
+        if(b.outSize == 0) return true;
+        z_stream strm;
+        std::memset(&strm, 0, sizeof(strm));
+        if(inflateInit2(&strm, -15) != Z_OK) return false;
+        strm.next_in   = const_cast<Bytef*>(in_.data() + b.in);
+        strm.avail_in  = uInt(b.inSize);
+        strm.next_out  = reinterpret_cast<Bytef*>(out);
+        strm.avail_out = uInt(b.outSize);
+        const int ret = inflate(&strm, Z_FINISH);
+        inflateEnd(&strm);
+        return ret == Z_STREAM_END && strm.avail_out == 0;
+    }
+
+
+    std::ifstream file_;
+    std::size_t chunkSize_;
+    std::vector<Bytef> in_;
+    std::vector<block> blocks_;
+    detail::job_pool pool_;
+    string filename_;
+};
+
+} // namespace
+
+
+
+//-------------------------------------------------------------------
+gzip_sequence_reader::gzip_sequence_reader(string filename, 
+                                           std::size_t chunkSize):
+    buffered_sequence_reader{},
+    pipe_{}
+{
+    auto inflater = std::make_shared<gzip_inflater>(filename, chunkSize);
+    pipe_.reset(new detail::chunk_pipeline{
+        [inflater](std::vector<char>& out) { return (*inflater)(out); } });
+    start();
+}
+
+gzip_sequence_reader::~gzip_sequence_reader() = default;
+
+
+//-------------------------------------------------------------------
+bool gzip_sequence_reader::next_chunk(const char*& begin, const char*& end)
+{
+    return pipe_->next(begin, end);
+}
+
+
+
+//-------------------------------------------------------------------
+bgzf_sequence_reader::bgzf_sequence_reader(string filename, int threads,
+                                           std::size_t chunkSize):
+    buffered_sequence_reader{},
+    pipe_{}
+{
+    auto inflater = std::make_shared<bgzf_inflater>(filename, threads, chunkSize);
+    pipe_.reset(new detail::chunk_pipeline{
+        [inflater](std::vector<char>& out) { return (*inflater)(out); } });
+    start();
+}
+
+bgzf_sequence_reader::~bgzf_sequence_reader() = default;
+
+
+//-------------------------------------------------------------------
+bool bgzf_sequence_reader::next_chunk(const char*& begin, const char*& end)
+{
+    return pipe_->next(begin, end);
+}
+
+
+
+//-------------------------------------------------------------------
+bool is_gzip_file(const string& filename)
+{
+    std::ifstream is {filename, std::ios::in | std::ios::binary};
+    unsigned char h[2] = {0,0};
+    is.read(reinterpret_cast<char*>(h), 2);
+    return is.gcount() == 2 && h[0] == 31 && h[1] == 139;
+}
+
+
+//-------------------------------------------------------------------
+bool is_bgzf_file(const string& filename)
+{
+    std::ifstream is {filename, std::ios::in | std::ios::binary};
+    unsigned char h[18];
+    is.read(reinterpret_cast<char*>(h), 18);
+    return is.gcount() == 18 && bgzf_block_size(h) > 0;
+}
+
+
+} // namespace anyseq
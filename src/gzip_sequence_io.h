@@ -0,0 +1,89 @@
+#ifndef ANYSEQ_GZIP_SEQUENCE_IO_H_
+#define ANYSEQ_GZIP_SEQUENCE_IO_H_
+
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "mapped_sequence_io.h"
+
+
+namespace anyseq {
+
+namespace detail { class chunk_pipeline; }
+
+
+/*************************************************************************//**
+ *
+ * @brief reads gzip compressed FASTA/FASTQ files;
+ *        inflates on a background thread into a double-buffered 
+ *        chunk pipeline, so parsing never waits for decompression
+ *        (as long as it is the slower of the two)
+ *
+ *****************************************************************************/
+class gzip_sequence_reader :
+    public buffered_sequence_reader
+{
+public:
+    explicit
+    gzip_sequence_reader(std::string filename, 
+                         std::size_t chunkSize = (1 << 22));
+
+    ~gzip_sequence_reader();
+
+protected:
+    bool next_chunk(const char*& begin, const char*& end) override;
+
+private:
+    std::unique_ptr<detail::chunk_pipeline> pipe_;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief reads BGZF compressed FASTA/FASTQ files (e.g. from bgzip);
+ *        BGZF blocks are independent, so batches of them are inflated 
+ *        in parallel on background threads 
+ *
+ * @param threads  number of inflating threads; 0: use the worker thread 
+ *                 count, but at most 4 (a single parser consumes the 
+ *                 inflated chunks, more inflaters rarely pay off)
+ *
+ *****************************************************************************/
+class bgzf_sequence_reader :
+    public buffered_sequence_reader
+{
+public:
+    explicit
+    bgzf_sequence_reader(std::string filename, 
+                         int threads = 0,
+                         std::size_t chunkSize = (1 << 22));
+
+    ~bgzf_sequence_reader();
+
+protected:
+    bool next_chunk(const char*& begin, const char*& end) override;
+
+private:
+    std::unique_ptr<detail::chunk_pipeline> pipe_;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief returns true, if the file starts with the gzip magic bytes
+ *
+ *****************************************************************************/
+bool is_gzip_file(const std::string& filename);
+
+/// @brief true, if the first gzip member contains the BGZF extra field
+bool is_bgzf_file(const std::string& filename);
+
+
+} // namespace anyseq
+
+
+#endif
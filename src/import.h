@@ -1,6 +1,7 @@
 #ifndef ANYSEQ_IMPALA_IMPORT_H_
 #define ANYSEQ_IMPALA_IMPORT_H_
 
+#include <cstdint>
 #include <vector>
 
 #include "config.h"
@@ -9,22 +10,53 @@
 extern "C" { 
 
 // functions with pre-configured scoring; defined in "export.impala"
+// query/subject hold nucleotide codes (see encode_dna in "sequence_io.h"),
+// alignment outputs hold characters;
+// alignments are written from index 0 of the output buffers (no padding), 
+// which hold alCapacity chars each (lenq+lens always suffices); 
+// alInfo[3] receives the aligned length and the first aligned position 
+// in query and subject; an aligned length beyond alCapacity means 
+// the outputs were truncated to their first alCapacity columns
 
 
 score_t construct_global_alignment(
     const char* query, int lenq, 
     const char* subject, int lens, 
-    char* alQuery, char* alSubject);
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo);
 
 score_t construct_semiglobal_alignment(
     const char* query, int lenq, 
     const char* subject, int lens, 
-    char* alQuery, char* alSubject);
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo);
 
 score_t construct_local_alignment(
     const char* query, int lenq, 
     const char* subject, int lens, 
-    char* alQuery, char* alSubject);
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo);
+
+
+
+// alignments as CIGAR operations: length << 4 | op  (BAM: 1 I, 2 D, 7 =, 8 X)
+// info[5]: number of operations, begin query, begin subject, 
+//          end query, end subject (end positions are exclusive);
+// if more than 'maxOps' operations are needed, only the first 'maxOps' 
+// are written and info[0] holds an upper bound of the required number 
+// (a buffer of that size is large enough)
+
+score_t construct_global_alignment_cigar(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    std::uint32_t* cigar, int maxOps, int* info);
+
+score_t construct_semiglobal_alignment_cigar(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    std::uint32_t* cigar, int maxOps, int* info);
+
+score_t construct_local_alignment_cigar(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    std::uint32_t* cigar, int maxOps, int* info);
 
 
 
@@ -42,6 +74,347 @@ score_t local_alignment_score(
 
 
 
+// functions with runtime scoring parameters
+
+
+score_t global_alignment_score_linear(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t match, score_t mismatch, score_t gap);
+
+score_t semiglobal_alignment_score_linear(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t match, score_t mismatch, score_t gap);
+
+score_t local_alignment_score_linear(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t match, score_t mismatch, score_t gap);
+
+
+score_t construct_global_alignment_linear(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    score_t match, score_t mismatch, score_t gap);
+
+score_t construct_semiglobal_alignment_linear(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    score_t match, score_t mismatch, score_t gap);
+
+score_t construct_local_alignment_linear(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    score_t match, score_t mismatch, score_t gap);
+
+
+// table: 4x4 substitution scores, row-major in ACGT order
+
+
+score_t global_alignment_score_subst(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gap);
+
+score_t semiglobal_alignment_score_subst(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gap);
+
+score_t local_alignment_score_subst(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gap);
+
+
+score_t construct_global_alignment_subst(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    const score_t* table, score_t gap);
+
+score_t construct_semiglobal_alignment_subst(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    const score_t* table, score_t gap);
+
+score_t construct_local_alignment_subst(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    const score_t* table, score_t gap);
+
+
+
+// amino acid alignments; sequences must be encoded with encode_protein,
+// table: substitution_matrix with protein_alphabet_size squared entries,
+// affine gaps: a gap of length k scores gapOpen + k * gapExtend
+
+
+score_t global_alignment_score_protein(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+score_t semiglobal_alignment_score_protein(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+score_t local_alignment_score_protein(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+
+score_t global_alignment_score_protein_striped(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+score_t semiglobal_alignment_score_protein_striped(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+score_t local_alignment_score_protein_striped(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+
+score_t construct_global_alignment_protein(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+score_t construct_semiglobal_alignment_protein(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+score_t construct_local_alignment_protein(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+
+
+// affine gaps: a gap of length k scores gapOpen + k * gapExtend
+
+
+score_t global_alignment_score_affine(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t match, score_t mismatch, score_t gapOpen, score_t gapExtend);
+
+score_t semiglobal_alignment_score_affine(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t match, score_t mismatch, score_t gapOpen, score_t gapExtend);
+
+score_t local_alignment_score_affine(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t match, score_t mismatch, score_t gapOpen, score_t gapExtend);
+
+
+score_t construct_global_alignment_affine(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    score_t match, score_t mismatch, score_t gapOpen, score_t gapExtend);
+
+score_t construct_semiglobal_alignment_affine(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    score_t match, score_t mismatch, score_t gapOpen, score_t gapExtend);
+
+score_t construct_local_alignment_affine(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    score_t match, score_t mismatch, score_t gapOpen, score_t gapExtend);
+
+
+
+// banded alignments; only cells within 'band' diagonals
+// of the main diagonal are computed
+
+
+score_t global_alignment_score_banded(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    int band);
+
+score_t semiglobal_alignment_score_banded(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    int band);
+
+score_t local_alignment_score_banded(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    int band);
+
+
+score_t construct_global_alignment_banded(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    int band);
+
+score_t construct_semiglobal_alignment_banded(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    int band);
+
+score_t construct_local_alignment_banded(
+    const char* query, int lenq, 
+    const char* subject, int lens, 
+    char* alQuery, char* alSubject, int alCapacity, int* alInfo,
+    int band);
+
+
+
+// striped intra-sequence SIMD (AVX backend); vectorizes within one
+// pair instead of over independent blocks; other backends fall back
+// to the regular kernels
+
+
+score_t global_alignment_score_striped(
+    const char* query, int lenq, 
+    const char* subject, int lens);
+
+score_t semiglobal_alignment_score_striped(
+    const char* query, int lenq, 
+    const char* subject, int lens);
+
+score_t local_alignment_score_striped(
+    const char* query, int lenq, 
+    const char* subject, int lens);
+
+
+
+// X-drop; regions of the matrix whose scores fell more than 'xdrop'
+// below the best score found so far are not computed any further
+
+
+score_t semiglobal_alignment_score_xdrop(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t xdrop);
+
+score_t local_alignment_score_xdrop(
+    const char* query, int lenq, 
+    const char* subject, int lens,
+    score_t xdrop);
+
+
+
+// database search: scores one query against 'numSubjects' subjects;
+// the query profile is built once per call
+
+void local_alignment_score_search(
+    const char* query, int lenq, 
+    const char* const* subjects, const int* lens,
+    int numSubjects, score_t* scores);
+
+void local_alignment_score_search_protein(
+    const char* query, int lenq, 
+    const char* const* subjects, const int* lens,
+    int numSubjects, score_t* scores,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+
+
+// all-vs-all scores of 'numSeqs' sequences written to 'scores'
+// layout: see score_layout in "score_matrix_io.h"
+
+void local_alignment_score_all_vs_all(
+    const char* const* seqs, const int* lens, int numSeqs,
+    int layout, score_t* scores);
+
+void local_alignment_score_all_vs_all_protein(
+    const char* const* seqs, const int* lens, int numSeqs,
+    int layout, score_t* scores,
+    const score_t* table, score_t gapOpen, score_t gapExtend);
+
+
+
+// batched versions; one score (and alignment) per query/subject pair
+// alignment buffers alQueries[i], alSubjects[i] must hold lenq[i]+lens[i] chars
+// alInfos[3*i .. 3*i+2]: aligned length, begin in query, begin in subject
+
+
+void global_alignment_score_batch(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores);
+
+void semiglobal_alignment_score_batch(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores);
+
+void local_alignment_score_batch(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores);
+
+
+// scores are first computed with 8 bit and 16 bit precision;
+// full precision is only used for pairs that overflow
+
+void global_alignment_score_batch_adaptive(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores);
+
+void semiglobal_alignment_score_batch_adaptive(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores);
+
+void local_alignment_score_batch_adaptive(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores);
+
+
+void construct_global_alignment_batch(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores,
+    char* const* alQueries, char* const* alSubjects,
+    int* alInfos);
+
+void construct_semiglobal_alignment_batch(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores,
+    char* const* alQueries, char* const* alSubjects,
+    int* alInfos);
+
+void construct_local_alignment_batch(
+    const char* const* queries, const int* lenq, 
+    const char* const* subjects, const int* lens,
+    int numPairs, score_t* scores,
+    char* const* alQueries, char* const* alSubjects,
+    int* alInfos);
+
+
+
 }
 
 #endif
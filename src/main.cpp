@@ -9,8 +9,13 @@
 #include <random>
 
 #include "import.h"        // AnySeq C interface
+#include "dispatch.h"      // runtime dispatch to specialized kernels
 #include "alignment_io.h"  // alignment result output
 #include "sequence_io.h"   // raw sequence input
+#include "substitution_matrix.h"  // amino acid scoring
+#include "database_search.h"  // query vs. database search
+#include "score_matrix_io.h"  // all-vs-all score output
+#include "threading.h"     // worker thread configuration
 #include "timer.h"         // benchmarking timer
 #include "clipp.h"         // command line args handling
 
@@ -38,6 +43,32 @@ private:
     std::uniform_int_distribution<char> rndNum_;
 };
 
+//-------------------------------------------------------------------
+class uniform_residue_distribution {
+public:
+    uniform_residue_distribution(): rndNum_{0,19} {}
+
+    template<class URNG>
+    char operator () (URNG& urng) {
+        return protein_symbols[rndNum_(urng)];
+    }
+
+private:
+    std::uniform_int_distribution<int> rndNum_;
+};
+
+template<class URNG>
+std::string random_protein(std::size_t minlen, std::size_t maxlen, URNG& urng)
+{
+    std::string s;
+    s.resize(std::uniform_int_distribution<std::size_t>{minlen,maxlen}(urng));
+
+    uniform_residue_distribution residues;
+    std::generate(begin(s), end(s), [&]{ return residues(urng); });
+
+    return s;
+}
+
 template<class URNG>
 std::string random_string(std::size_t minlen, std::size_t maxlen, URNG& urng)
 {
@@ -64,14 +95,45 @@ void benchmark_align(const std::string& name,
 {
     os << "testing " << name << std::flush;
 
+    int info[3] = {0};
     am::timer time;
     time.start();
-    volatile auto score = align(q.c_str(), q.size(),
-                                s.c_str(), s.size(),
-                                &alq.front(), &als.front());
+    const auto score = align(q.c_str(), q.size(),
+                             s.c_str(), s.size(),
+                             &alq.front(), &als.front(), int(alq.size()), info);
     time.stop();
 
-    os << " " << time.milliseconds() << " ms" << std::endl;
+    os << " " << time.milliseconds() << " ms, score " << score << std::endl;
+}
+
+
+//-------------------------------------------------------------------
+// CIGAR output needs memory proportional to the number of edit runs;
+// the buffer is grown if it was too small (to the reported upper bound)
+template<class Function>
+void benchmark_cigar(const std::string& name,
+               Function&& align, 
+               const std::string& q, const std::string& s,
+               std::vector<std::uint32_t>& cigar,
+               std::ostream& os)
+{
+    os << "testing " << name << std::flush;
+
+    int info[5] = {0};
+    am::timer time;
+    time.start();
+    const auto score = align(q.c_str(), q.size(), s.c_str(), s.size(),
+                             cigar.data(), int(cigar.size()), info);
+    time.stop();
+
+    os << " " << time.milliseconds() << " ms, score " << score << ", ";
+    if(info[0] > int(cigar.size())) {
+        os << "buffer too small for up to " << info[0] << " operations";
+        cigar.resize(info[0]);
+    } else {
+        os << info[0] << " operations";
+    }
+    os << std::endl;
 }
 
 
@@ -86,10 +148,10 @@ void benchmark_score(const std::string& name,
 
     am::timer time;
     time.start();
-    volatile auto score = align(q.c_str(), q.size(), s.c_str(), s.size());
+    const auto score = align(q.c_str(), q.size(), s.c_str(), s.size());
     time.stop();
 
-    os << " " << time.milliseconds() << " ms" << std::endl;
+    os << " " << time.milliseconds() << " ms, score " << score << std::endl;
 }
 
 
@@ -106,6 +168,15 @@ void benchmark_alignments(const std::string& q, const std::string& s,
     benchmark_score("local score",
         local_alignment_score, q, s, os);
 
+    benchmark_score("global striped score", 
+        global_alignment_score_striped, q, s, os);
+
+    benchmark_score("semiglobal striped score",
+        semiglobal_alignment_score_striped, q, s, os);
+
+    benchmark_score("local striped score",
+        local_alignment_score_striped, q, s, os);
+
 
     const auto alen = q.size() + s.size();
 
@@ -120,9 +191,375 @@ void benchmark_alignments(const std::string& q, const std::string& s,
 
     benchmark_align("local alignment",
         construct_local_alignment, q, s, alq, als, os);
+
+
+    std::vector<std::uint32_t> cigar(1024);
+
+    benchmark_cigar("global CIGAR alignment", 
+        construct_global_alignment_cigar, q, s, cigar, os);
+
+    benchmark_cigar("semiglobal CIGAR alignment", 
+        construct_semiglobal_alignment_cigar, q, s, cigar, os);
+
+    benchmark_cigar("local CIGAR alignment", 
+        construct_local_alignment_cigar, q, s, cigar, os);
+}
+
+
+//-------------------------------------------------------------------
+// uses pre-evaluated kernels if the scoring parameters match 
+// a build-time specialization and runtime-parameterized kernels otherwise
+void benchmark_alignments(const std::string& q, const std::string& s,
+                          const linear_scoring_params& sp,
+                          std::ostream& os)
+{
+    os << "runtime scoring (" << sp.match << "," << sp.mismatch << "," 
+       << sp.gap << ") uses " 
+       << (is_specialized(alignment_type::global, sp) ? "specialized" : "generic")
+       << " kernels" << std::endl;
+
+    benchmark_score("global score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return alignment_score(alignment_type::global, sp, q, lq, s, ls);
+        }, q, s, os);
+
+    benchmark_score("semiglobal score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return alignment_score(alignment_type::semiglobal, sp, q, lq, s, ls);
+        }, q, s, os);
+
+    benchmark_score("local score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return alignment_score(alignment_type::local, sp, q, lq, s, ls);
+        }, q, s, os);
+
+
+    const auto alen = q.size() + s.size();
+
+    std::string alq; alq.resize(alen, ' ');
+    std::string als; als.resize(alen, ' ');
+
+    benchmark_align("global alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_alignment(alignment_type::global, sp, 
+                                       q, lq, s, ls, aq, as, ac, ai);
+        }, q, s, alq, als, os);
+
+    benchmark_align("semiglobal alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_alignment(alignment_type::semiglobal, sp, 
+                                       q, lq, s, ls, aq, as, ac, ai);
+        }, q, s, alq, als, os);
+
+    benchmark_align("local alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_alignment(alignment_type::local, sp, 
+                                       q, lq, s, ls, aq, as, ac, ai);
+        }, q, s, alq, als, os);
+}
+
+
+//-------------------------------------------------------------------
+// amino acid sequences; affine gaps
+void benchmark_protein_alignments(const std::string& q, const std::string& s,
+                                  const substitution_matrix& m,
+                                  score_t gapOpen, score_t gapExtend,
+                                  std::ostream& os)
+{
+    os << "protein scoring, gaps (" << gapOpen << "," << gapExtend << ")" << std::endl;
+
+    const auto table = m.data();
+
+    benchmark_score("global protein score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return global_alignment_score_protein(q, lq, s, ls, table, gapOpen, gapExtend);
+        }, q, s, os);
+
+    benchmark_score("semiglobal protein score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return semiglobal_alignment_score_protein(q, lq, s, ls, table, gapOpen, gapExtend);
+        }, q, s, os);
+
+    benchmark_score("local protein score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return local_alignment_score_protein(q, lq, s, ls, table, gapOpen, gapExtend);
+        }, q, s, os);
+
+    benchmark_score("local striped protein score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return local_alignment_score_protein_striped(q, lq, s, ls, table, gapOpen, gapExtend);
+        }, q, s, os);
+
+
+    const auto alen = q.size() + s.size();
+
+    std::string alq; alq.resize(alen, ' ');
+    std::string als; als.resize(alen, ' ');
+
+    benchmark_align("global protein alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_global_alignment_protein(q, lq, s, ls, aq, as, ac, ai, 
+                                                      table, gapOpen, gapExtend);
+        }, q, s, alq, als, os);
+
+    benchmark_align("local protein alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_local_alignment_protein(q, lq, s, ls, aq, as, ac, ai, 
+                                                     table, gapOpen, gapExtend);
+        }, q, s, alq, als, os);
+}
+
+
+//-------------------------------------------------------------------
+// all query records against every record of the database file;
+// score-only first, alignments only for the best 'topK' hits
+void search(const std::string& queryFile, const std::string& dbFile,
+            std::size_t topK, bool protein, const substitution_matrix& m,
+            score_t gapOpen, score_t gapExtend,
+            std::ostream& os)
+{
+    search_kernels kernels;
+    if(protein) {
+        const auto table = m.data();
+        kernels.score = [=](const char* q, int lq, 
+                            const char* const* s, const int* ls, 
+                            int n, score_t* scores) {
+            local_alignment_score_search_protein(q, lq, s, ls, n, scores, 
+                                                 table, gapOpen, gapExtend);
+        };
+        kernels.align = [=](const char* q, int lq, const char* s, int ls, 
+                            char* aq, char* as, int ac, int* ai) {
+            return construct_local_alignment_protein(q, lq, s, ls, aq, as, ac, ai, 
+                                                     table, gapOpen, gapExtend);
+        };
+        kernels.encode = [](std::string& s) { encode_protein(s); };
+    } else {
+        kernels.score = local_alignment_score_search;
+        kernels.align = construct_local_alignment;
+        kernels.encode = [](std::string& s) { encode_dna(s); };
+    }
+
+    std::vector<std::string> headers;
+    std::vector<std::string> queries;
+    auto qreader = make_sequence_reader(queryFile);
+    while(qreader->has_next()) {
+        auto seq = qreader->next();
+        if(seq.data.empty()) continue;
+        kernels.encode(seq.data);
+        headers.push_back(std::move(seq.header));
+        queries.push_back(std::move(seq.data));
+    }
+    os << "queries: " << queries.size() << std::endl;
+
+    search_options opt;
+    opt.topK = topK;
+
+    auto db = make_sequence_reader(dbFile);
+
+    am::timer time;
+    time.start();
+    const auto results = search_database(queries, *db, kernels, opt);
+    time.stop();
+
+    os << "database records: " << db->index() << '\n'
+       << "search time: " << time.milliseconds() << " ms" << std::endl;
+
+    for(std::size_t q = 0; q < results.size(); ++q) {
+        os << "\nquery " << headers[q] << '\n';
+        int rank = 0;
+        for(const auto& hit : results[q]) {
+            os << '#' << ++rank << " record " << hit.record 
+               << " " << hit.header 
+               << "\nbegin " << hit.queryBegin << " " << hit.subjectBegin
+               << "\nscore ";
+            print_alignment(os, hit.score, hit.alignedQuery, hit.alignedSubject);
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------
+// only computes cells within 'band' diagonals of the main diagonal
+void benchmark_banded_alignments(const std::string& q, const std::string& s,
+                                 int band, std::ostream& os)
+{
+    os << "band: " << band << std::endl;
+
+    benchmark_score("global banded score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return global_alignment_score_banded(q, lq, s, ls, band);
+        }, q, s, os);
+
+    benchmark_score("semiglobal banded score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return semiglobal_alignment_score_banded(q, lq, s, ls, band);
+        }, q, s, os);
+
+    benchmark_score("local banded score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return local_alignment_score_banded(q, lq, s, ls, band);
+        }, q, s, os);
+
+
+    const auto alen = q.size() + s.size();
+
+    std::string alq; alq.resize(alen, ' ');
+    std::string als; als.resize(alen, ' ');
+
+    benchmark_align("global banded alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_global_alignment_banded(q, lq, s, ls, aq, as, ac, ai, band);
+        }, q, s, alq, als, os);
+
+    benchmark_align("semiglobal banded alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_semiglobal_alignment_banded(q, lq, s, ls, aq, as, ac, ai, band);
+        }, q, s, alq, als, os);
+
+    benchmark_align("local banded alignment", 
+        [&](const char* q, int lq, const char* s, int ls, char* aq, char* as, int ac, int* ai) {
+            return construct_local_alignment_banded(q, lq, s, ls, aq, as, ac, ai, band);
+        }, q, s, alq, als, os);
+}
+
+
+//-------------------------------------------------------------------
+// stops computing regions that fell 'xdrop' below the best score
+void benchmark_xdrop_alignments(const std::string& q, const std::string& s,
+                                int xdrop, std::ostream& os)
+{
+    os << "x-drop: " << xdrop << std::endl;
+
+    benchmark_score("semiglobal x-drop score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return semiglobal_alignment_score_xdrop(q, lq, s, ls, xdrop);
+        }, q, s, os);
+
+    benchmark_score("local x-drop score", 
+        [&](const char* q, int lq, const char* s, int ls) {
+            return local_alignment_score_xdrop(q, lq, s, ls, xdrop);
+        }, q, s, os);
 }
 
 
+//-------------------------------------------------------------------
+template<class Function>
+void benchmark_score_batch(const std::string& name,
+               Function&& align, 
+               const std::vector<const char*>& qs, const std::vector<int>& lenq,
+               const std::vector<const char*>& ss, const std::vector<int>& lens,
+               std::vector<score_t>& scores,
+               std::ostream& os)
+{
+    os << "testing " << name << std::flush;
+
+    am::timer time;
+    time.start();
+    align(qs.data(), lenq.data(), ss.data(), lens.data(), 
+          int(qs.size()), scores.data());
+    time.stop();
+
+    os << " " << time.milliseconds() << " ms" << std::endl;
+}
+
+
+//-------------------------------------------------------------------
+void benchmark_batch_alignments(const std::vector<std::string>& queries, 
+                                const std::vector<std::string>& subjects,
+                                std::ostream& os)
+{
+    const auto n = std::min(queries.size(), subjects.size());
+
+    std::vector<const char*> qs; qs.reserve(n);
+    std::vector<const char*> ss; ss.reserve(n);
+    std::vector<int> lenq; lenq.reserve(n);
+    std::vector<int> lens; lens.reserve(n);
+
+    for(std::size_t i = 0; i < n; ++i) {
+        qs.push_back(queries[i].c_str());
+        ss.push_back(subjects[i].c_str());
+        lenq.push_back(int(queries[i].size()));
+        lens.push_back(int(subjects[i].size()));
+    }
+
+    std::vector<score_t> scores(n, 0);
+
+    benchmark_score_batch("global score batch",
+        global_alignment_score_batch, qs, lenq, ss, lens, scores, os);
+
+    benchmark_score_batch("semiglobal score batch",
+        semiglobal_alignment_score_batch, qs, lenq, ss, lens, scores, os);
+
+    benchmark_score_batch("local score batch",
+        local_alignment_score_batch, qs, lenq, ss, lens, scores, os);
+
+    benchmark_score_batch("global score batch (adaptive precision)",
+        global_alignment_score_batch_adaptive, qs, lenq, ss, lens, scores, os);
+
+    benchmark_score_batch("semiglobal score batch (adaptive precision)",
+        semiglobal_alignment_score_batch_adaptive, qs, lenq, ss, lens, scores, os);
+
+    benchmark_score_batch("local score batch (adaptive precision)",
+        local_alignment_score_batch_adaptive, qs, lenq, ss, lens, scores, os);
+}
+
+
+//-------------------------------------------------------------------
+// scores of all pairs of records of one file; 
+// scores are written to a memory-mapped binary file (see score_matrix_io.h),
+// record headers to '<outfile>.names' (one per line, same order)
+void all_vs_all(const std::string& seqFile, const std::string& outfile,
+                score_layout layout, bool protein, const substitution_matrix& m,
+                score_t gapOpen, score_t gapExtend,
+                std::ostream& os)
+{
+    std::ofstream names {outfile + ".names"};
+    if(!names.good()) {
+        throw file_access_error{"could not open file " + outfile + ".names"};
+    }
+
+    std::vector<std::string> seqs;
+    auto reader = make_sequence_reader(seqFile);
+    while(reader->has_next()) {
+        auto seq = reader->next();
+        if(seq.data.empty()) continue;
+        if(protein) encode_protein(seq.data); else encode_dna(seq.data);
+        names << seq.header << '\n';
+        seqs.push_back(std::move(seq.data));
+    }
+    const int n = int(seqs.size());
+    os << "sequences: " << n << std::endl;
+
+    std::vector<const char*> ptrs;
+    std::vector<int> lens;
+    ptrs.reserve(n);
+    lens.reserve(n);
+    for(const auto& s : seqs) {
+        ptrs.push_back(s.data());
+        lens.push_back(int(s.size()));
+    }
+
+    mapped_score_matrix out {outfile, std::uint64_t(n), layout};
+
+    am::timer time;
+    time.start();
+    if(protein) {
+        local_alignment_score_all_vs_all_protein(ptrs.data(), lens.data(), n,
+            int(layout), out.data(), m.data(), gapOpen, gapExtend);
+    } else {
+        local_alignment_score_all_vs_all(ptrs.data(), lens.data(), n,
+            int(layout), out.data());
+    }
+    time.stop();
+    out.flush();
+
+    os << "pairs: " << (std::uint64_t(n) * (n > 0 ? n-1 : 0) / 2) << '\n'
+       << "scores: " << out.entries() << " -> " << outfile << '\n'
+       << "time: " << time.milliseconds() << " ms" << std::endl;
+}
+
+
+
 //-------------------------------------------------------------------
 int main(int argc, char* argv[]) 
 {
@@ -136,6 +573,20 @@ int main(int argc, char* argv[])
     auto output = omode::stdio;
     std::int64_t minlen = 256;
     std::int64_t maxlen = 1024;
+    std::int64_t numPairs = 0;
+    int band = -1;
+    int xdrop = -1;
+    int threads = 0;
+    std::size_t topK = 0;
+    bool allVsAll = false;
+    bool fullMatrix = false;
+    std::string pinning;
+    bool runtimeScoring = false;
+    bool protein = false;
+    std::string matrixFile;
+    score_t gapOpen = -11;
+    score_t gapExtend = -1;
+    linear_scoring_params scoring;
     std::string query, subject;
     std::string outfile;
     std::vector<std::string> wrong;
@@ -149,6 +600,13 @@ int main(int argc, char* argv[])
             value("query file", query),
             value("subject file", subject)
         ) | 
+        "score all pairs of sequences of one file" % (
+            command("-A", "--all-vs-all").set(allVsAll),
+            value("sequence file", query),
+            value("output file", outfile),
+            option("--full").set(fullMatrix) % 
+                "write the full symmetric matrix instead of the upper triangle"
+        ) | 
         // "specify sequences on the command line" % (
         //     command("-a", "--args").set(input,imode::args),
         //     value("query string", query),
@@ -157,12 +615,43 @@ int main(int argc, char* argv[])
         "generate random input sequences" % (
             command("-r", "--rand").set(input,imode::random),
             opt_integer("min len", minlen) &
-            opt_integer("max len", maxlen)
+            opt_integer("max len", maxlen),
+            (option("-b", "--batch") & integer("pairs", numPairs)) % 
+                "align many random pairs with the batch interface"
         ),
         // | ( 
         // "read sequences from stdin" %
         //     command("-").set(input,imode::stdio)
         // )
+        (option("-s", "--scoring").set(runtimeScoring) & 
+         integer("match", scoring.match) & 
+         integer("mismatch", scoring.mismatch) & 
+         integer("gap", scoring.gap)) % "use runtime scoring parameters"
+        ,
+        (option("-P", "--protein").set(protein) & 
+         opt_value("matrix file", matrixFile)) % 
+            "align amino acid sequences (default matrix: BLOSUM62)"
+        ,
+        (option("-g", "--gaps") & 
+         integer("open", gapOpen) & integer("extend", gapExtend)) % 
+            "affine gap scores for amino acid sequences (default: -11 -1)"
+        ,
+        (option("-k", "--search") & integer("hits", topK)) % 
+            "search all query records against every record of the subject file "
+            "and report the best <hits> for each query"
+        ,
+        (option("-w", "--band") & integer("width", band)) % 
+            "only compute cells within <width> diagonals of the main diagonal"
+        ,
+        (option("-x", "--xdrop") & integer("drop", xdrop)) % 
+            "stop computing regions <drop> below the best score"
+        ,
+        (option("-t", "--threads") & integer("n", threads)) % 
+            "number of worker threads (default: ANYSEQ_THREADS or all cores)"
+        ,
+        (option("-p", "--pin") & value("mode", pinning)) % 
+            "pin worker threads to 'cores' or 'numa' nodes"
+        ,
         any_other(wrong)
     );
 
@@ -176,6 +665,56 @@ int main(int argc, char* argv[])
         return 0;
     }
 
+    if(threads > 0) set_thread_count(threads);
+
+    if(pinning == "cores") {
+        set_thread_affinity(thread_affinity::cores);
+    } else if(pinning == "numa") {
+        set_thread_affinity(thread_affinity::numa);
+    } else if(!pinning.empty() && pinning != "none") {
+        std::cerr << "Unknown pinning mode '" << pinning << "'" << endl;
+        return 1;
+    }
+    cout << "threads: " << thread_count() << endl;
+
+    substitution_matrix matrix;
+    if(protein) {
+        try {
+            matrix = matrixFile.empty() ? blosum62() 
+                                        : read_substitution_matrix(matrixFile);
+        }
+        catch(std::exception& e) {
+            std::cerr << e.what() << endl;
+            return 1;
+        }
+    }
+
+    if(topK > 0 && input == imode::file) {
+        cout << "database search: " << query << " vs. " << subject << endl;
+        try {
+            search(query, subject, topK, protein, matrix, gapOpen, gapExtend, cout);
+        }
+        catch(std::exception& e) {
+            std::cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if(allVsAll) {
+        cout << "all-vs-all: " << query << " -> " << outfile << endl;
+        try {
+            all_vs_all(query, outfile, 
+                       fullMatrix ? score_layout::full : score_layout::condensed,
+                       protein, matrix, gapOpen, gapExtend, cout);
+        }
+        catch(std::exception& e) {
+            std::cerr << e.what() << endl;
+            return 1;
+        }
+        return 0;
+    }
+
     switch(input) {
         default:
         case imode::file:
@@ -208,18 +747,56 @@ int main(int argc, char* argv[])
             if(maxlen < minlen) std::swap(minlen,maxlen);
             cout << "random strings with length from [" << minlen << "," << maxlen << "]\n";
             std::mt19937_64 urng;
-            query = random_string(minlen,maxlen,urng);
-            subject = random_string(minlen,maxlen,urng);
+            if(numPairs > 0) {
+                cout << "random pairs: " << numPairs << endl;
+                std::vector<std::string> queries, subjects;
+                queries.reserve(numPairs);
+                subjects.reserve(numPairs);
+                for(std::int64_t i = 0; i < numPairs; ++i) {
+                    queries.push_back(random_string(minlen,maxlen,urng));
+                    subjects.push_back(random_string(minlen,maxlen,urng));
+                    encode_dna(queries.back());
+                    encode_dna(subjects.back());
+                }
+                benchmark_batch_alignments(queries, subjects, cout);
+                return 0;
+            }
+            if(protein) {
+                query = random_protein(minlen,maxlen,urng);
+                subject = random_protein(minlen,maxlen,urng);
+            } else {
+                query = random_string(minlen,maxlen,urng);
+                subject = random_string(minlen,maxlen,urng);
+            }
             break;
         }
     }
 
     cout << "sequence lengths: " << query.size() << ", " << subject.size() << endl;
 
+    if(protein) {
+        encode_protein(query);
+        encode_protein(subject);
+    } else {
+        encode_dna(query);
+        encode_dna(subject);
+    }
+
     switch(output) {
         default:
         case omode::stdio:             
-            benchmark_alignments(query, subject, cout);
+            if(protein) {
+                benchmark_protein_alignments(query, subject, matrix, 
+                                             gapOpen, gapExtend, cout);
+            } else if(band >= 0) {
+                benchmark_banded_alignments(query, subject, band, cout);
+            } else if(xdrop >= 0) {
+                benchmark_xdrop_alignments(query, subject, xdrop, cout);
+            } else if(runtimeScoring) {
+                benchmark_alignments(query, subject, scoring, cout);
+            } else {
+                benchmark_alignments(query, subject, cout);
+            }
             break;
         case omode::file: {
             if(outfile.empty()) {
@@ -228,7 +805,18 @@ int main(int argc, char* argv[])
             }
             std::ofstream os{outfile};
             if(os.good()) {
-                benchmark_alignments(query, subject, os);
+                if(protein) {
+                    benchmark_protein_alignments(query, subject, matrix, 
+                                                 gapOpen, gapExtend, os);
+                } else if(band >= 0) {
+                    benchmark_banded_alignments(query, subject, band, os);
+                } else if(xdrop >= 0) {
+                    benchmark_xdrop_alignments(query, subject, xdrop, os);
+                } else if(runtimeScoring) {
+                    benchmark_alignments(query, subject, scoring, os);
+                } else {
+                    benchmark_alignments(query, subject, os);
+                }
             } else {
                 std::cerr << "Unable to open output file!" << endl;
                 return 1;
@@ -0,0 +1,242 @@
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ANYSEQ_HAS_MMAP
+#endif
+
+#include "io_error.h"
+#include "mapped_sequence_io.h"
+
+
+namespace anyseq {
+
+using std::string;
+
+
+//-------------------------------------------------------------------
+buffered_sequence_reader::buffered_sequence_reader():
+    sequence_reader{},
+    pos_{nullptr}, end_{nullptr}, eof_{false}, lastLength_{0}
+{}
+
+
+
+//-------------------------------------------------------------------
+void buffered_sequence_reader::start()
+{
+    skip_blank();
+    if(peek() < 0) invalidate();
+}
+
+
+
+//-------------------------------------------------------------------
+bool buffered_sequence_reader::fill()
+{
+    while(pos_ == end_) {
+        if(eof_) return false;
+        if(!next_chunk(pos_, end_)) {
+            eof_ = true;
+            pos_ = end_ = nullptr;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//-------------------------------------------------------------------
+int buffered_sequence_reader::peek()
+{
+    return fill() ? int(static_cast<unsigned char>(*pos_)) : -1;
+}
+
+
+//-------------------------------------------------------------------
+void buffered_sequence_reader::skip_blank()
+{
+    while(fill()) {
+        const char c = *pos_;
+        if(c != '\n' && c != '\r' && c != ' ' && c != '\t') return;
+        ++pos_;
+    }
+}
+
+
+//-------------------------------------------------------------------
+void buffered_sequence_reader::skip_line()
+{
+    while(fill()) {
+        auto nl = static_cast<const char*>(std::memchr(pos_, '\n', end_ - pos_));
+        if(nl) {
+            pos_ = nl + 1;
+            return;
+        }
+        pos_ = end_;
+    }
+}
+
+
+//-------------------------------------------------------------------
+// appends the rest of the current line without line break
+void buffered_sequence_reader::append_line(string& out)
+{
+    while(fill()) {
+        auto nl = static_cast<const char*>(std::memchr(pos_, '\n', end_ - pos_));
+        if(nl) {
+            out.append(pos_, nl);
+            pos_ = nl + 1;
+            break;
+        }
+        out.append(pos_, end_);
+        pos_ = end_;
+    }
+    if(!out.empty() && out.back() == '\r') out.pop_back();
+}
+
+
+
+//-------------------------------------------------------------------
+void buffered_sequence_reader::read_next(sequence& seq)
+{
+    skip_blank();
+
+    switch(peek()) {
+        case -1:  invalidate(); return;
+        case '>': read_fasta(seq); break;
+        case '@': read_fastq(seq); break;
+        default:
+            invalidate();
+            throw io_format_error{"malformed input - expected FASTA or FASTQ header"};
+    }
+    
+    lastLength_ = seq.data.size();
+
+    skip_blank();
+    if(peek() < 0) invalidate();
+}
+
+
+//-------------------------------------------------------------------
+void buffered_sequence_reader::read_fasta(sequence& seq)
+{
+    ++pos_;  // '>'
+    seq.header.clear();
+    append_line(seq.header);
+
+    seq.data.clear();
+    seq.data.reserve(lastLength_);
+    while(peek() >= 0 && *pos_ != '>') {
+        append_line(seq.data);
+    }
+
+    if(seq.data.empty()) {
+        throw io_format_error{"malformed fasta file - zero-length sequence: " + seq.header};
+    }
+}
+
+
+//-------------------------------------------------------------------
+void buffered_sequence_reader::read_fastq(sequence& seq)
+{
+    ++pos_;  // '@'
+    seq.header.clear();
+    append_line(seq.header);
+
+    seq.data.clear();
+    seq.data.reserve(lastLength_);
+    while(peek() >= 0 && *pos_ != '+') {
+        append_line(seq.data);
+    }
+
+    if(peek() != '+') {
+        invalidate();
+        throw io_format_error{"malformed fastq file - quality header missing: " + seq.header};
+    }
+    skip_line();
+
+    // quality lines may start with '@', so rely on the sequence length
+    seq.qualities.clear();
+    seq.qualities.reserve(seq.data.size());
+    while(seq.qualities.size() < seq.data.size() && peek() >= 0) {
+        append_line(seq.qualities);
+    }
+}
+
+
+
+
+//-------------------------------------------------------------------
+mapped_sequence_reader::mapped_sequence_reader(string filename, 
+                                               std::size_t streamBufferSize):
+    buffered_sequence_reader{},
+    map_{nullptr}, mapSize_{0}, mapConsumed_{false},
+    stream_{}, buffer_{}
+{
+#ifdef ANYSEQ_HAS_MMAP
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd >= 0) {
+        struct stat st;
+        if(::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* m = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, 
+                             MAP_PRIVATE, fd, 0);
+            if(m != MAP_FAILED) {
+                map_ = m;
+                mapSize_ = std::size_t(st.st_size);
+                ::madvise(map_, mapSize_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    if(!map_) {
+        stream_.open(filename.c_str(), std::ios::in | std::ios::binary);
+        if(!stream_.good()) {
+            invalidate();
+            throw file_access_error{"can't open file " + filename};
+        }
+        buffer_.resize(streamBufferSize > 0 ? streamBufferSize : 4096);
+    }
+
+    start();
+}
+
+
+
+//-------------------------------------------------------------------
+mapped_sequence_reader::~mapped_sequence_reader()
+{
+#ifdef ANYSEQ_HAS_MMAP
+    if(map_) ::munmap(map_, mapSize_);
+#endif
+}
+
+
+
+//-------------------------------------------------------------------
+bool mapped_sequence_reader::next_chunk(const char*& begin, const char*& end)
+{
+    if(map_) {
+        if(mapConsumed_) return false;
+        mapConsumed_ = true;
+        begin = static_cast<const char*>(map_);
+        end = begin + mapSize_;
+        return true;
+    }
+
+    if(!stream_.good()) return false;
+    stream_.read(buffer_.data(), std::streamsize(buffer_.size()));
+    const auto n = stream_.gcount();
+    if(n <= 0) return false;
+    begin = buffer_.data();
+    end = begin + n;
+    return true;
+}
+
+
+} // namespace anyseq
@@ -0,0 +1,95 @@
+#ifndef ANYSEQ_MAPPED_SEQUENCE_IO_H_
+#define ANYSEQ_MAPPED_SEQUENCE_IO_H_
+
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "sequence_io.h"
+
+
+namespace anyseq {
+
+
+/*************************************************************************//**
+ *
+ * @brief parses FASTA and FASTQ records (format is determined per record)
+ *        from a sequence of raw input chunks
+ *
+ * Line ends are located with memchr and whole line segments are appended 
+ * at once, so there is no per-character work or per-line allocation.
+ * Records may span any number of chunks.
+ *
+ *****************************************************************************/
+class buffered_sequence_reader :
+    public sequence_reader
+{
+protected:
+    buffered_sequence_reader();
+
+    /**
+     * @brief derived readers have to provide the next chunk of input;
+     *        the chunk has to stay valid until the next call;
+     *        returns false if there is no more input
+     */
+    virtual bool next_chunk(const char*& begin, const char*& end) = 0;
+
+    /** @brief has to be called by derived constructors (after setup) */
+    void start();
+
+    void read_next(sequence&) override;
+
+private:
+    bool fill();
+    int peek();
+    void skip_blank();
+    void skip_line();
+    void append_line(std::string&);
+    void read_fasta(sequence&);
+    void read_fastq(sequence&);
+
+    const char* pos_;
+    const char* end_;
+    bool eof_;
+    std::size_t lastLength_;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief reads FASTA/FASTQ files via a read-only memory mapping;
+ *        falls back to buffered streaming if the file can't be mapped
+ *        (pipes, special files, unsupported platforms)
+ *
+ *****************************************************************************/
+class mapped_sequence_reader :
+    public buffered_sequence_reader
+{
+public:
+    explicit
+    mapped_sequence_reader(std::string filename, 
+                           std::size_t streamBufferSize = (1 << 22));
+
+    ~mapped_sequence_reader();
+
+    bool is_mapped() const noexcept { return map_ != nullptr; }
+
+protected:
+    bool next_chunk(const char*& begin, const char*& end) override;
+
+private:
+    void* map_;
+    std::size_t mapSize_;
+    bool mapConsumed_;
+    std::ifstream stream_;
+    std::vector<char> buffer_;
+};
+
+
+} // namespace anyseq
+
+
+#endif
@@ -0,0 +1,114 @@
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define ANYSEQ_HAS_MMAP
+#endif
+
+#include "io_error.h"
+#include "score_matrix_io.h"
+
+
+namespace anyseq {
+
+
+//-------------------------------------------------------------------
+std::uint64_t score_matrix_entries(std::uint64_t n, score_layout layout) noexcept
+{
+    if(layout == score_layout::full) return n * n;
+    return n > 1 ? n * (n - 1) / 2 : 0;
+}
+
+
+//-------------------------------------------------------------------
+namespace {
+
+void write_header(char* h, std::uint64_t n, score_layout layout)
+{
+    const std::uint32_t version = 1;
+    const auto lay = static_cast<std::uint32_t>(layout);
+    const std::uint32_t bytes = sizeof(score_t);
+
+    std::memset(h, 0, mapped_score_matrix::header_size);
+    std::memcpy(h,      "ANYSEQSM", 8);
+    std::memcpy(h +  8, &version, 4);
+    std::memcpy(h + 12, &lay, 4);
+    std::memcpy(h + 16, &n, 8);
+    std::memcpy(h + 24, &bytes, 4);
+}
+
+} // namespace
+
+
+
+//-------------------------------------------------------------------
+mapped_score_matrix::mapped_score_matrix(const std::string& filename, 
+                                         std::uint64_t n, score_layout layout):
+    filename_{filename},
+    n_{n}, entries_{score_matrix_entries(n, layout)}, layout_{layout},
+    map_{nullptr}, mapSize_{0}, buffer_{}, data_{nullptr}
+{
+    const auto size = header_size + entries_ * sizeof(score_t);
+
+#ifdef ANYSEQ_HAS_MMAP
+    const int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        throw file_access_error{"can't create file " + filename};
+    }
+    if(::ftruncate(fd, off_t(size)) == 0) {
+        void* m = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if(m != MAP_FAILED) {
+            map_ = m;
+            mapSize_ = size;
+        }
+    }
+    ::close(fd);
+#endif
+
+    char* mem = nullptr;
+    if(map_) {
+        mem = static_cast<char*>(map_);
+    } else {
+        buffer_.resize(size);
+        mem = buffer_.data();
+    }
+    write_header(mem, n_, layout_);
+    data_ = reinterpret_cast<score_t*>(mem + header_size);
+}
+
+
+
+//-------------------------------------------------------------------
+mapped_score_matrix::~mapped_score_matrix()
+{
+    try { flush(); } catch(...) {}
+#ifdef ANYSEQ_HAS_MMAP
+    if(map_) ::munmap(map_, mapSize_);
+#endif
+}
+
+
+
+//-------------------------------------------------------------------
+void mapped_score_matrix::flush()
+{
+#ifdef ANYSEQ_HAS_MMAP
+    if(map_) {
+        if(::msync(map_, mapSize_, MS_SYNC) != 0) {
+            throw file_io_error{"can't write file", filename_};
+        }
+        return;
+    }
+#endif
+    std::ofstream os {filename_, std::ios::out | std::ios::binary};
+    os.write(buffer_.data(), std::streamsize(buffer_.size()));
+    if(!os.good()) {
+        throw file_io_error{"can't write file", filename_};
+    }
+}
+
+
+} // namespace anyseq
@@ -0,0 +1,81 @@
+#ifndef ANYSEQ_SCORE_MATRIX_IO_H_
+#define ANYSEQ_SCORE_MATRIX_IO_H_
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+
+namespace anyseq {
+
+
+/*************************************************************************//**
+ *
+ * @brief storage order of all-vs-all scores of n sequences
+ *        condensed: pairs i < j row by row, n*(n-1)/2 entries;
+ *                   (i,j) is at  i*(2n-i-1)/2 + j-i-1
+ *        full:      symmetric n x n matrix, row-major; diagonal is 0
+ *
+ *****************************************************************************/
+enum class score_layout : std::uint32_t {
+    condensed = 0, full = 1
+};
+
+
+/// @brief number of scores stored for n sequences
+std::uint64_t score_matrix_entries(std::uint64_t n, score_layout) noexcept;
+
+
+
+/*************************************************************************//**
+ *
+ * @brief binary file of all-vs-all scores, mapped into memory so that 
+ *        kernels write the scores directly into the file
+ *
+ *        file layout (host byte order):
+ *          0: "ANYSEQSM"   8: u32 version   12: u32 layout
+ *         16: u64 number of sequences       24: u32 bytes per score
+ *         64: scores (score_t)
+ *
+ *****************************************************************************/
+class mapped_score_matrix
+{
+public:
+    static constexpr std::size_t header_size = 64;
+
+    mapped_score_matrix(const std::string& filename, 
+                        std::uint64_t n, score_layout);
+
+    ~mapped_score_matrix();
+
+    mapped_score_matrix(const mapped_score_matrix&) = delete;
+    mapped_score_matrix& operator = (const mapped_score_matrix&) = delete;
+
+    std::uint64_t sequences() const noexcept { return n_; }
+    std::uint64_t entries() const noexcept { return entries_; }
+    score_layout layout() const noexcept { return layout_; }
+
+    score_t* data() noexcept { return data_; }
+
+    /** @brief writes all scores to disk */
+    void flush();
+
+private:
+    std::string filename_;
+    std::uint64_t n_;
+    std::uint64_t entries_;
+    score_layout layout_;
+    void* map_;
+    std::size_t mapSize_;
+    std::vector<char> buffer_;   //used if mmap isn't available
+    score_t* data_;
+};
+
+
+} // namespace anyseq
+
+
+#endif
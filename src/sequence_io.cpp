@@ -1,7 +1,10 @@
+#include <cctype>
 #include <sstream>
 
 #include "io_error.h"
 #include "sequence_io.h"
+#include "mapped_sequence_io.h"
+#include "gzip_sequence_io.h"
 
 
 namespace anyseq {
@@ -25,6 +28,22 @@ sequence_reader::next()
 
 
 
+//-------------------------------------------------------------------
+void sequence_reader::next(sequence& seq)
+{
+    seq.header.clear();
+    seq.data.clear();
+    seq.qualities.clear();
+    if(!has_next()) return;
+
+    std::lock_guard<std::mutex> lock(mutables_);
+    ++index_;
+    seq.index = index_;
+    read_next(seq);
+}
+
+
+
 //-------------------------------------------------------------------
 void sequence_reader::skip(index_type skip)
 {
@@ -202,22 +221,92 @@ void sequence_header_reader::read_next(sequence& seq)
 
 
 
+//-------------------------------------------------------------------
+namespace {
+
+struct dna_code_table {
+    dna_code_table() noexcept {
+        for(auto& c : codes) c = 4;
+        codes['A'] = codes['a'] = 0;
+        codes['C'] = codes['c'] = 1;
+        codes['G'] = codes['g'] = 2;
+        codes['T'] = codes['t'] = 3;
+    }
+    char codes[256];
+};
+
+struct protein_code_table {
+    protein_code_table() noexcept {
+        for(auto& c : codes) c = char(protein_code_x);
+        for(int i = 0; i < protein_alphabet_size; ++i) {
+            const auto c = static_cast<unsigned char>(protein_symbols[i]);
+            codes[c] = char(i);
+            codes[std::tolower(c)] = char(i);
+        }
+    }
+    char codes[256];
+};
+
+const protein_code_table& protein_codes() {
+    static const protein_code_table table;
+    return table;
+}
+
+} // namespace
+
+
+void encode_dna(char* first, char* last) noexcept
+{
+    static const dna_code_table table;
+    for(; first != last; ++first) {
+        *first = table.codes[static_cast<unsigned char>(*first)];
+    }
+}
+
+
+//-------------------------------------------------------------------
+int protein_code(char c) noexcept
+{
+    return protein_codes().codes[static_cast<unsigned char>(c)];
+}
+
+
+void encode_protein(char* first, char* last) noexcept
+{
+    const auto& table = protein_codes();
+    for(; first != last; ++first) {
+        *first = table.codes[static_cast<unsigned char>(*first)];
+    }
+}
+
+
+
 //-------------------------------------------------------------------
 std::unique_ptr<sequence_reader>
 make_sequence_reader(const string& filename)
 {
     auto n = filename.size();
+    if((n > 3 && filename.rfind(".gz")   == (n-3)) ||
+       (n > 4 && filename.rfind(".bgz")  == (n-4)) ||
+       (n > 5 && filename.rfind(".bgzf") == (n-5)) ||
+       is_gzip_file(filename))
+    {
+        if(is_bgzf_file(filename)) {
+            return std::unique_ptr<sequence_reader>{new bgzf_sequence_reader{filename}};
+        }
+        return std::unique_ptr<sequence_reader>{new gzip_sequence_reader{filename}};
+    }
     if(filename.find(".fq")    == (n-3) ||
        filename.find(".fnq")   == (n-4) ||
        filename.find(".fastq") == (n-6) )
     {
-        return std::unique_ptr<sequence_reader>{new fastq_reader{filename}};
+        return std::unique_ptr<sequence_reader>{new mapped_sequence_reader{filename}};
     }
     else if(filename.find(".fa")    == (n-3) ||
             filename.find(".fna")   == (n-4) ||
             filename.find(".fasta") == (n-6) )
     {
-        return std::unique_ptr<sequence_reader>{new fasta_reader{filename}};
+        return std::unique_ptr<sequence_reader>{new mapped_sequence_reader{filename}};
     }
 
     //try to determine file type content
@@ -226,11 +315,8 @@ make_sequence_reader(const string& filename)
         string line;
         getline(is,line);
         if(!line.empty()) {
-            if(line[0] == '>') {
-                return std::unique_ptr<sequence_reader>{new fasta_reader{filename}};
-            }
-            else if(line[0] == '@') {
-                return std::unique_ptr<sequence_reader>{new fastq_reader{filename}};
+            if(line[0] == '>' || line[0] == '@') {
+                return std::unique_ptr<sequence_reader>{new mapped_sequence_reader{filename}};
             }
         }
         throw file_read_error{"file format not recognized"};
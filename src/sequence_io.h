@@ -44,6 +44,9 @@ public:
     /** @brief read & return next sequence */
     sequence next();
 
+    /** @brief read next sequence into 'seq', reusing its memory */
+    void next(sequence& seq);
+
     /** @brief skip n sequences */
     void skip(index_type n);
 
@@ -134,7 +137,8 @@ private:
 /*************************************************************************//**
  *
  * @brief guesses and returns a suitable sequence reader
- *        based on a filename pattern
+ *        based on a filename pattern;
+ *        plain FASTA/FASTQ files are memory mapped if possible
  *
  *****************************************************************************/
 std::unique_ptr<sequence_reader>
@@ -142,6 +146,44 @@ make_sequence_reader(const std::string& filename);
 
 
 
+/*************************************************************************//**
+ *
+ * @brief encodes nucleotides in place into the codes 
+ *        expected by the alignment kernels:
+ *        A=0, C=1, G=2, T=3 (case-insensitive), anything else=4;
+ *        should be done once right after loading
+ *
+ *****************************************************************************/
+void encode_dna(char* first, char* last) noexcept;
+
+inline void encode_dna(std::string& s) noexcept {
+    encode_dna(&s[0], &s[0] + s.size());
+}
+
+
+
+/*************************************************************************//**
+ *
+ * @brief amino acid codes: position in 'protein_symbols' (NCBI matrix order);
+ *        the 20 standard residues come first, unknown residues are X
+ *
+ *****************************************************************************/
+constexpr const char* protein_symbols = "ARNDCQEGHILKMFPSTWYVBZX*";
+constexpr int protein_alphabet_size = 24;
+constexpr int protein_code_x = 22;
+
+/// @brief code of one residue (case-insensitive)
+int protein_code(char) noexcept;
+
+/// @brief encodes amino acids in place (see 'protein_code')
+void encode_protein(char* first, char* last) noexcept;
+
+inline void encode_protein(std::string& s) noexcept {
+    encode_protein(&s[0], &s[0] + s.size());
+}
+
+
+
 } // namespace anyseq
 
 
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "io_error.h"
+#include "sequence_io.h"
+#include "substitution_matrix.h"
+
+
+namespace anyseq {
+
+using std::string;
+
+
+//-------------------------------------------------------------------
+namespace {
+
+// residue code of a matrix header letter; -1 if not in the alphabet
+int matrix_code(char c) noexcept
+{
+    const auto p = std::strchr(protein_symbols, std::toupper(c));
+    return (p && c != '\0') ? int(p - protein_symbols) : -1;
+}
+
+} // namespace
+
+
+
+//-------------------------------------------------------------------
+substitution_matrix read_substitution_matrix(std::istream& is)
+{
+    constexpr auto none = std::numeric_limits<score_t>::min();
+    substitution_matrix m {protein_alphabet_size, none};
+
+    std::vector<int> cols;
+    std::vector<bool> present(protein_alphabet_size, false);
+    score_t minScore = std::numeric_limits<score_t>::max();
+
+    string line;
+    while(std::getline(is, line)) {
+        const auto first = line.find_first_not_of(" \t\r");
+        if(first == string::npos || line[first] == '#') continue;
+
+        std::istringstream ls {line};
+        if(cols.empty()) {
+            char c;
+            while(ls >> c) cols.push_back(matrix_code(c));
+            continue;
+        }
+
+        char r;
+        ls >> r;
+        const int row = matrix_code(r);
+        for(std::size_t i = 0; i < cols.size(); ++i) {
+            score_t score;
+            if(!(ls >> score)) {
+                throw io_format_error{"substitution matrix: incomplete row '" + 
+                                      string(1,r) + "'"};
+            }
+            if(row >= 0 && cols[i] >= 0) {
+                m(row, cols[i]) = score;
+                minScore = std::min(minScore, score);
+            }
+        }
+        if(row >= 0) present[row] = true;
+    }
+
+    if(cols.empty() || std::none_of(present.begin(), present.end(), 
+                                    [](bool b) { return b; })) 
+    {
+        throw io_format_error{"substitution matrix: no scores found"};
+    }
+
+    // missing entries score like X
+    const int x = protein_code_x;
+    for(int q = 0; q < m.size(); ++q) {
+        for(int s = 0; s < m.size(); ++s) {
+            if(m(q,s) != none) continue;
+            if(m(x,s) != none)      m(q,s) = m(x,s);
+            else if(m(q,x) != none) m(q,s) = m(q,x);
+            else                    m(q,s) = minScore;
+        }
+    }
+    return m;
+}
+
+
+//-------------------------------------------------------------------
+substitution_matrix read_substitution_matrix(const string& filename)
+{
+    std::ifstream is {filename};
+    if(!is.good()) {
+        throw file_access_error{"can't open substitution matrix " + filename};
+    }
+    return read_substitution_matrix(is);
+}
+
+
+//-------------------------------------------------------------------
+const substitution_matrix& blosum62()
+{
+    static const substitution_matrix m = [] {
+        std::istringstream is {
+            "   A  R  N  D  C  Q  E  G  H  I  L  K  M  F  P  S  T  W  Y  V  B  Z  X  *\n"
+            "A  4 -1 -2 -2  0 -1 -1  0 -2 -1 -1 -1 -1 -2 -1  1  0 -3 -2  0 -2 -1  0 -4\n"
+            "R -1  5  0 -2 -3  1  0 -2  0 -3 -2  2 -1 -3 -2 -1 -1 -3 -2 -3 -1  0 -1 -4\n"
+            "N -2  0  6  1 -3  0  0  0  1 -3 -3  0 -2 -3 -2  1  0 -4 -2 -3  3  0 -1 -4\n"
+            "D -2 -2  1  6 -3  0  2 -1 -1 -3 -4 -1 -3 -3 -1  0 -1 -4 -3 -3  4  1 -1 -4\n"
+            "C  0 -3 -3 -3  9 -3 -4 -3 -3 -1 -1 -3 -1 -2 -3 -1 -1 -2 -2 -1 -3 -3 -2 -4\n"
+            "Q -1  1  0  0 -3  5  2 -2  0 -3 -2  1  0 -3 -1  0 -1 -2 -1 -2  0  3 -1 -4\n"
+            "E -1  0  0  2 -4  2  5 -2  0 -3 -3  1 -2 -3 -1  0 -1 -3 -2 -2  1  4 -1 -4\n"
+            "G  0 -2  0 -1 -3 -2 -2  6 -2 -4 -4 -2 -3 -3 -2  0 -2 -2 -3 -3 -1 -2 -1 -4\n"
+            "H -2  0  1 -1 -3  0  0 -2  8 -3 -3 -1 -2 -1 -2 -1 -2 -2  2 -3  0  0 -1 -4\n"
+            "I -1 -3 -3 -3 -1 -3 -3 -4 -3  4  2 -3  1  0 -3 -2 -1 -3 -1  3 -3 -3 -1 -4\n"
+            "L -1 -2 -3 -4 -1 -2 -3 -4 -3  2  4 -2  2  0 -3 -2 -1 -2 -1  1 -4 -3 -1 -4\n"
+            "K -1  2  0 -1 -3  1  1 -2 -1 -3 -2  5 -1 -3 -1  0 -1 -3 -2 -2  0  1 -1 -4\n"
+            "M -1 -1 -2 -3 -1  0 -2 -3 -2  1  2 -1  5  0 -2 -1 -1 -1 -1  1 -3 -1 -1 -4\n"
+            "F -2 -3 -3 -3 -2 -3 -3 -3 -1  0  0 -3  0  6 -4 -2 -2  1  3 -1 -3 -3 -1 -4\n"
+            "P -1 -2 -2 -1 -3 -1 -1 -2 -2 -3 -3 -1 -2 -4  7 -1 -1 -4 -3 -2 -2 -1 -2 -4\n"
+            "S  1 -1  1  0 -1  0  0  0 -1 -2 -2  0 -1 -2 -1  4  1 -3 -2 -2  0  0  0 -4\n"
+            "T  0 -1  0 -1 -1 -1 -1 -2 -2 -1 -1 -1 -1 -2 -1  1  5 -2 -2  0 -1 -1  0 -4\n"
+            "W -3 -3 -4 -4 -2 -2 -3 -2 -2 -3 -2 -3 -1  1 -4 -3 -2 11  2 -3 -4 -3 -2 -4\n"
+            "Y -2 -2 -2 -3 -2 -1 -2 -3  2 -1 -1 -2 -1  3 -3 -2 -2  2  7 -1 -3 -2 -1 -4\n"
+            "V  0 -3 -3 -3 -1 -2 -2 -3 -3  3  1 -2  1 -1 -2 -2  0 -3 -1  4 -3 -2 -1 -4\n"
+            "B -2 -1  3  4 -3  0  1 -1  0 -3 -4  0 -3 -3 -2  0 -1 -4 -3 -3  4  1 -1 -4\n"
+            "Z -1  0  0  1 -3  3  4 -2  0 -3 -3  1 -1 -3 -1  0 -1 -3 -2 -2  1  4 -1 -4\n"
+            "X  0 -1 -1 -1 -2 -1 -1 -1 -1 -1 -1 -1 -1 -1 -2  0  0 -2 -1 -1 -1 -1 -1 -4\n"
+            "* -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4 -4  1\n"
+        };
+        return read_substitution_matrix(is);
+    }();
+    return m;
+}
+
+
+} // namespace anyseq
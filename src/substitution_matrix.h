@@ -0,0 +1,74 @@
+#ifndef ANYSEQ_SUBSTITUTION_MATRIX_H_
+#define ANYSEQ_SUBSTITUTION_MATRIX_H_
+
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+
+namespace anyseq {
+
+
+/*************************************************************************//**
+ *
+ * @brief square table of substitution scores over amino acid codes 
+ *        (see 'encode_protein' in "sequence_io.h");
+ *        row-major (query code = row), as expected by the *_protein kernels
+ *
+ *****************************************************************************/
+class substitution_matrix
+{
+public:
+    explicit
+    substitution_matrix(int size = 0, score_t init = 0):
+        size_{size}, scores_(std::size_t(size) * size, init)
+    {}
+
+    int size() const noexcept { return size_; }
+
+    score_t operator () (int q, int s) const noexcept { 
+        return scores_[q * size_ + s]; 
+    }
+    score_t& operator () (int q, int s) noexcept { 
+        return scores_[q * size_ + s]; 
+    }
+
+    const score_t* data() const noexcept { return scores_.data(); }
+
+private:
+    int size_;
+    std::vector<score_t> scores_;
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief reads an amino acid matrix in NCBI format (as distributed with BLAST):
+ *        '#' comments, one header line of residue letters, 
+ *        then one line per residue: <letter> <scores...>;
+ *        residues missing from the file score like X
+ *        (or with the minimum score if X is missing as well)
+ *
+ *****************************************************************************/
+substitution_matrix read_substitution_matrix(std::istream&);
+
+substitution_matrix read_substitution_matrix(const std::string& filename);
+
+
+
+/*************************************************************************//**
+ *
+ * @brief built-in BLOSUM62
+ *
+ *****************************************************************************/
+const substitution_matrix& blosum62();
+
+
+} // namespace anyseq
+
+
+#endif
@@ -0,0 +1,312 @@
+/**
+ * worker thread configuration; 
+ * the C functions at the end are called from the Impala side
+ **/
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "threading.h"
+
+
+namespace anyseq {
+
+
+//-----------------------------------------------------------------------------
+// state of one parallel region (opaque on the Impala side)
+struct parallel_region {
+    std::atomic<int> next {0};  // next item to hand out
+    bool nested = false;        // started inside another region
+};
+
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// global state
+//-----------------------------------------------------------------------------
+std::once_flag envFlag;
+std::atomic<int> threadCount {0};
+std::atomic<int> affinity {int(thread_affinity::none)};
+
+// incremented whenever the affinity changes, so that workers re-pin
+std::atomic<int> affinityGeneration {1};
+
+// per thread: number of running parallel regions that it started and 
+// number of worker bodies (of any region) that it is running
+thread_local int regionDepth = 0;
+thread_local int workerDepth = 0;
+// affinity generation and worker index this thread is pinned for
+thread_local int pinnedGeneration = 0;
+thread_local int pinnedWorker = -1;
+
+
+
+//-------------------------------------------------------------------
+int hardware_threads()
+{
+    const auto n = int(std::thread::hardware_concurrency());
+    return n > 0 ? n : 1;
+}
+
+
+//-------------------------------------------------------------------
+void read_environment()
+{
+    std::call_once(envFlag, [] {
+        if(threadCount.load() < 1) {
+            const char* threads = std::getenv("ANYSEQ_THREADS");
+            const int n = threads ? std::atoi(threads) : 0;
+            threadCount.store(n > 0 ? n : hardware_threads());
+        }
+
+        const char* mode = std::getenv("ANYSEQ_AFFINITY");
+        if(mode && affinity.load() == int(thread_affinity::none)) {
+            const std::string m {mode};
+            if(m == "cores") {
+                affinity.store(int(thread_affinity::cores));
+            } 
+            else if(m == "numa") {
+                affinity.store(int(thread_affinity::numa));
+            }
+        }
+    });
+}
+
+
+#ifdef __linux__
+
+//-------------------------------------------------------------------
+// parses sysfs cpu lists like "0-3,8,10-11"
+std::vector<int> parse_cpu_list(const std::string& list)
+{
+    std::vector<int> cpus;
+    std::size_t pos = 0;
+    while(pos < list.size()) {
+        auto end = list.find(',', pos);
+        if(end == std::string::npos) end = list.size();
+        const auto range = list.substr(pos, end - pos);
+        const auto dash = range.find('-');
+        if(!range.empty()) {
+            const int first = std::atoi(range.c_str());
+            const int last = dash == std::string::npos 
+                           ? first : std::atoi(range.c_str() + dash + 1);
+            for(int c = first; c <= last; ++c) cpus.push_back(c);
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+
+//-------------------------------------------------------------------
+std::vector<std::vector<int>> numa_nodes()
+{
+    std::vector<std::vector<int>> nodes;
+    for(int n = 0; ; ++n) {
+        std::ifstream is {"/sys/devices/system/node/node" + 
+                          std::to_string(n) + "/cpulist"};
+        if(!is.good()) break;
+        std::string list;
+        std::getline(is, list);
+        auto cpus = parse_cpu_list(list);
+        if(!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    return nodes;
+}
+
+
+//-------------------------------------------------------------------
+// process-wide allowed cores and NUMA nodes; determined once
+const std::vector<int>& allowed_cores()
+{
+    static const std::vector<int> cores = [] {
+        std::vector<int> cs;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for(int c = 0; c < CPU_SETSIZE; ++c) {
+                if(CPU_ISSET(c, &set)) cs.push_back(c);
+            }
+        }
+        return cs;
+    }();
+    return cores;
+}
+
+const std::vector<std::vector<int>>& allowed_nodes()
+{
+    static const std::vector<std::vector<int>> nodes = numa_nodes();
+    return nodes;
+}
+
+
+//-------------------------------------------------------------------
+void pin_current_thread(const std::vector<int>& cpus)
+{
+    if(cpus.empty()) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(int c : cpus) CPU_SET(c, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+#endif
+
+
+//-------------------------------------------------------------------
+// pins the calling thread to the slot (core or node) of 'worker'; 
+// cheap if the thread already runs on that slot
+void pin_worker(int worker)
+{
+    const int generation = affinityGeneration.load(std::memory_order_relaxed);
+    if(pinnedGeneration == generation && pinnedWorker == worker) return;
+    const bool wasPinned = pinnedGeneration > 0;
+    pinnedGeneration = generation;
+    pinnedWorker = worker;
+
+#ifdef __linux__
+    const auto slot = std::size_t(worker > 0 ? worker : 0);
+
+    switch(get_thread_affinity()) {
+        default:
+        case thread_affinity::none: 
+            // undo the pinning of an earlier affinity setting
+            if(wasPinned) pin_current_thread(allowed_cores());
+            break;
+        case thread_affinity::cores: {
+            const auto& cores = allowed_cores();
+            if(!cores.empty()) {
+                pin_current_thread({cores[slot % cores.size()]});
+            }
+            break;
+        }
+        case thread_affinity::numa: {
+            const auto& nodes = allowed_nodes();
+            if(!nodes.empty()) {
+                pin_current_thread(nodes[slot % nodes.size()]);
+            }
+            break;
+        }
+    }
+#else
+    (void)wasPinned;
+#endif
+}
+
+
+} // namespace
+
+
+
+//-------------------------------------------------------------------
+void set_thread_count(int n)
+{
+    read_environment();
+    threadCount.store(n > 0 ? n : hardware_threads());
+}
+
+//-------------------------------------------------------------------
+int thread_count()
+{
+    read_environment();
+    return threadCount.load();
+}
+
+
+//-------------------------------------------------------------------
+void set_thread_affinity(thread_affinity a)
+{
+    read_environment();
+    affinity.store(int(a));
+    ++affinityGeneration;
+}
+
+//-------------------------------------------------------------------
+thread_affinity get_thread_affinity()
+{
+    read_environment();
+    return thread_affinity(affinity.load());
+}
+
+
+} // namespace anyseq
+
+
+
+//-----------------------------------------------------------------------------
+// Impala interface
+//-----------------------------------------------------------------------------
+extern "C" {
+
+int anyseq_thread_count() 
+{
+    return anyseq::thread_count();
+}
+
+
+//-----------------------------------------------------------------------------
+// called on the thread that starts a parallel region, before and after it;
+// a region started by a worker of another region (or inside one) is nested
+anyseq::parallel_region* anyseq_parallel_begin()
+{
+    using namespace anyseq;
+
+    auto region = new parallel_region;
+    region->nested = regionDepth > 0 || workerDepth > 0;
+    ++regionDepth;
+    return region;
+}
+
+void anyseq_parallel_end(anyseq::parallel_region* region)
+{
+    --anyseq::regionDepth;
+    delete region;
+}
+
+int anyseq_parallel_nested()
+{
+    return anyseq::regionDepth > 0 || anyseq::workerDepth > 0;
+}
+
+
+//-----------------------------------------------------------------------------
+// hands out the next 'count' items of a region; returns the first one
+int anyseq_next_items(anyseq::parallel_region* region, int count)
+{
+    return region->next.fetch_add(count, std::memory_order_relaxed);
+}
+
+
+//-----------------------------------------------------------------------------
+// called at the start and end of every worker of a parallel region; 
+// pool threads are pinned to the slot (core or node) of their worker index 
+// in outermost regions only; the thread that started the region 
+// (e.g. the main thread, which also runs workers with TBB) is never pinned, 
+// so it doesn't pass a mask on to threads it creates later
+void anyseq_worker_begin(anyseq::parallel_region* region, int worker)
+{
+    using namespace anyseq;
+
+    if(!region->nested && regionDepth == 0 && workerDepth == 0) {
+        pin_worker(worker);
+    }
+    ++workerDepth;
+}
+
+void anyseq_worker_end()
+{
+    --anyseq::workerDepth;
+}
+
+} // extern "C"
@@ -0,0 +1,56 @@
+#ifndef ANYSEQ_THREADING_H_
+#define ANYSEQ_THREADING_H_
+
+
+namespace anyseq {
+
+
+/*************************************************************************//**
+ *
+ * @brief how worker threads of the CPU/AVX backends are pinned
+ *
+ *****************************************************************************/
+enum class thread_affinity {
+    none,   ///< threads may run on any core
+    cores,  ///< worker k runs on allowed core k (modulo the core count)
+    numa    ///< worker k runs on the cores of NUMA node k (modulo the node count)
+};
+
+
+
+/*************************************************************************//**
+ *
+ * @brief sets the number of worker threads used by all following 
+ *        alignments; n < 1 selects the number of hardware threads
+ *
+ * If not set, the environment variable ANYSEQ_THREADS is used.
+ *
+ *****************************************************************************/
+void set_thread_count(int n);
+
+/// @brief number of worker threads used by the CPU/AVX backends
+int thread_count();
+
+
+
+/*************************************************************************//**
+ *
+ * @brief sets how worker threads are pinned to cores
+ *
+ * If not set, the environment variable ANYSEQ_AFFINITY 
+ * ("none", "cores" or "numa") is used.
+ * Only pool threads are pinned; the thread that starts an alignment 
+ * keeps its affinity, even if it runs workers itself.
+ * Workers of nested parallel regions are never (re-)pinned.
+ * Pinning is only supported on Linux and ignored elsewhere.
+ *
+ *****************************************************************************/
+void set_thread_affinity(thread_affinity);
+
+thread_affinity get_thread_affinity();
+
+
+} // namespace anyseq
+
+
+#endif